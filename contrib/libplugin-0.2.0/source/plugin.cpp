@@ -25,6 +25,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <stack>
 #include <map>
 #include <algorithm>
+#include <boost/thread/recursive_mutex.hpp>
 #include <plugin/plugin.hpp>
 
 namespace plugin {
@@ -84,6 +85,7 @@ class DefaultManager: public IManager
 	dependencies_t m_dependencies;
 	std::vector<dependency_t*> m_instance_index;
 	std::stack<std::vector<std::string>*> m_creation;
+	mutable boost::recursive_mutex m_mutex;
 
 public:
 	bool register_factory (const std::string& a_interface_tag,
@@ -117,6 +119,7 @@ private:
 bool DefaultManager::register_factory (const std::string& a_interface_tag,
 		IFactory* a_factory, const bool a_delegate_factory_ownership)
 {
+	boost::recursive_mutex::scoped_lock lock(m_mutex);
 	dependencies_t::iterator i = m_dependencies. find(a_interface_tag);
 	if (i != m_dependencies. end())
 	{
@@ -131,6 +134,7 @@ bool DefaultManager::register_factory (const std::string& a_interface_tag,
 
 bool DefaultManager::unregister_factory (IFactory* a_factory)
 {
+	boost::recursive_mutex::scoped_lock lock(m_mutex);
 	dependencies_t::iterator i = std::find_if(m_dependencies. begin(),
 			m_dependencies. end(), factory_pointer_matcher(a_factory));
 	if (i == m_dependencies. end())
@@ -154,11 +158,13 @@ bool DefaultManager::unregister_factory (IFactory* a_factory)
 
 bool DefaultManager::factory_exists (const std::string& a_interface_tag) const
 {
+	boost::recursive_mutex::scoped_lock lock(m_mutex);
 	return m_dependencies. find(a_interface_tag) != m_dependencies. end();
 }
 
 IPluggable* DefaultManager::create (const std::string& a_interface_tag)
 {
+	boost::recursive_mutex::scoped_lock lock(m_mutex);
 	// Verify that a factory producing instances of the requested type has been
 	// registered.
 	dependencies_t::iterator i = m_dependencies. find(a_interface_tag);
@@ -235,6 +241,7 @@ IPluggable* DefaultManager::create (const std::string& a_interface_tag)
 
 IPluggable* DefaultManager::validate (const IPluggable* a_instance) const
 {
+	boost::recursive_mutex::scoped_lock lock(m_mutex);
 	std::vector<dependency_t*>::const_iterator i = std::lower_bound(
 			m_instance_index. begin(), m_instance_index. end(), a_instance,
 			instance_pointer_comparator());
@@ -257,11 +264,13 @@ IPluggable* DefaultManager::validate (const IPluggable* a_instance) const
 
 bool DefaultManager::dispose (IPluggable* a_instance)
 {
+	boost::recursive_mutex::scoped_lock lock(m_mutex);
 	return destroy(a_instance, false);
 }
 
 void DefaultManager::list (const callback_type& a_callback) const
 {
+	boost::recursive_mutex::scoped_lock lock(m_mutex);
 	for (dependencies_t::const_iterator i = m_dependencies. begin();
 			i != m_dependencies. end(); ++ i)
 	{
@@ -274,6 +283,7 @@ void DefaultManager::list (const callback_type& a_callback) const
 
 void DefaultManager::shutdown ()
 {
+	boost::recursive_mutex::scoped_lock lock(m_mutex);
 	assert(m_creation. empty());
 	while (! m_dependencies. empty())
 	{
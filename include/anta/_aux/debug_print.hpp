@@ -225,6 +225,9 @@ public:
 		case anta::evBLOCK:	*m_out << "block"; break;
 		case anta::evSPLIT:	*m_out << "split"; break;
 		case anta::evDEFER:	*m_out << "defer"; break;
+		case anta::evSUSPEND:	*m_out << "susp "; break;
+		case anta::evPRUNE:	*m_out << "prune"; break;
+		case anta::evMERGE:	*m_out << "merge"; break;
 		case anta::evEVICT:	*m_out << "evict\n";
 		default:
 			return;
@@ -54,17 +54,35 @@ public:
 	bool next ()
 	{
 		if (! m_next)
+		{
 			m_trace_it = m_processor. get_traced(). begin();
-		else
+			m_choices. clear();
+		}
+		else if (! choose())
+		{
 			++ m_trace_it;
+		}
 
 		m_next = false;
 		for ( ; m_trace_it != m_processor. get_traced(). end(); ++ m_trace_it)
 		{
 			m_trace. clear();
-			const State<M_>* s;
-			for (s = *m_trace_it; s != NULL; s = s -> get_ancestor())
+			const State<M_>* s = *m_trace_it;
+			std::size_t k = 0;
+			for (ancestry<M_> a(s); s != NULL; s = a. next())
 			{
+				// Substitute the chosen state for a state that other states
+				// have been folded into by merging.
+				const folded_t* folded = m_processor. get_merged(s);
+				if (folded != NULL && ! folded -> empty())
+				{
+					if (k == m_choices. size())
+						m_choices. push_back(std::make_pair(s, 0));
+					const std::size_t c = m_choices[k ++]. second;
+					if (c != 0)
+						a = ancestry<M_>(s = (*folded)[c - 1]);
+				}
+
 				assert(! s -> is_blocked());
 				if (s -> is_split() || s -> get_arc(). get_label(). is_actual())
 					m_trace. push_back(s);
@@ -142,6 +160,7 @@ public:
 		m_next = false;
 		m_step = false;
 		m_trace. clear();
+		m_choices. clear();
 	}
 
 	/**
@@ -193,9 +212,32 @@ public:
 		return s;
 	}
 
+private:
+	/**
+	 *	Make the next choice among the states folded into the states of the
+	 *	current trace, the nearest to the beginning of the trace first.
+	 *
+	 *	@return
+	 *		Whether there is a choice left for the current trace
+	 */
+	bool choose ()
+	{
+		while (! m_choices. empty())
+		{
+			if (++ m_choices. back(). second <=
+					m_processor. get_merged(m_choices. back(). first) -> size())
+				return true;
+			m_choices. pop_back();
+		}
+		return false;
+	}
+
 private:
 	const Processor<M_>& m_processor;
 	bool m_next, m_step;
+	typedef typename merge_entry<M_>::states_type folded_t;
+	typedef std::vector<std::pair<const State<M_>*, std::size_t> > choices_t;
+	choices_t m_choices;
 	typedef std::vector<const anta::State<M_>*> trace_t;
 	trace_t m_trace;
 	typename Processor<M_>::traced_type::const_iterator m_trace_it;
@@ -29,8 +29,11 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 // [ standard library, boost ]
 #include <assert.h>
+#include <algorithm>
 #include <vector>
+#include <map>
 #include <queue>
+#include <boost/unordered_map.hpp>
 #include <stdexcept>
 
 // [ contributed ]
@@ -45,6 +45,9 @@ enum observer_event_t
 	evSPLIT,	/**< new split state has been spawned */
 	evDEFER,	/**< entangled state has been deferred */
 	evEVICT,	/**< evict state from the pool */
+	evSUSPEND,	/**< caller state has been suspended on a memoized invocation */
+	evPRUNE,	/**< queued state has been pruned off the beam */
+	evMERGE,	/**< state has been folded into an equivalent one */
 
 };
 
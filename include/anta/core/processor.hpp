@@ -91,6 +91,31 @@ inline void rollback (Processor_& a_proc, const State<M_>* a_state)
 	rollback_performer<Processor_, M_>::f(a_proc, a_state);
 }
 
+/**
+ *	The definition and the default implementation of the defunct state disposal
+ *	mechanism. It reclaims the memory occupied by a state that is known to have
+ *	no descendants, wherever the state resides in the memory pool.
+ */
+template <typename Processor_, typename M_>
+struct disposal_performer
+{
+	static void f (Processor_& a_proc, const State<M_>* a_state)
+	{
+		a_proc. get_observer(). notify(evEVICT, a_state);
+		a_proc. reclaim(a_state, a_state -> size());
+	}
+
+};
+
+/**
+ *	An invocation helper for the defunct state disposal mechanism.
+ */
+template <typename Processor_, typename M_>
+inline void dispose (Processor_& a_proc, const State<M_>* a_state)
+{
+	disposal_performer<Processor_, M_>::f(a_proc, a_state);
+}
+
 /**
  *	The default specialization of the template base class for the Processor.
  *
@@ -119,11 +144,118 @@ protected:
 		return true;
 	}
 
+	/**
+	 *	Get a digest of the environment an invocation entry state has been
+	 *	entered in. Basic models have no environment besides the source range.
+	 */
+	const void* memo_digest (const State<M_>* a_state) const
+	{
+		return NULL;
+	}
+
 protected:
 	State<M_>* m_state; /**< current state pointer */
 
 };
 
+/**
+ *	memo_entry<M_> keeps track of a memoized invocation: the key it has been
+ *	registered with, the entry states of callers that have been suspended on it
+ *	and the final states reached so far.
+ */
+template <typename M_>
+struct memo_entry
+{
+	/**
+	 *	The key type for memoized invocations: (target node, source range,
+	 *	environment digest).
+	 */
+	typedef std::pair<
+				std::pair<const Node<M_>*, typename range<M_>::type>,
+				const void*
+			> key_type;
+
+	typedef std::vector<const State<M_>*> states_type;
+
+	key_type key;
+	states_type callers;
+	states_type results;
+	bool orphaned;
+
+	/**
+	 *	The only constructor.
+	 *
+	 *	@param	a_key
+	 *		Invocation key
+	 */
+	memo_entry (const key_type& a_key):
+		key (a_key), orphaned (false)
+	{
+	}
+
+};
+
+/**
+ *	merge_entry<M_> keeps track of equivalent states merged at push time: the
+ *	key the first of them has been registered with and the states that have
+ *	been folded into it since.
+ */
+template <typename M_>
+struct merge_entry
+{
+	/**
+	 *	The key type for merged states: (arc, source range, callee of the
+	 *	ancestor, environment digest).
+	 */
+	typedef std::pair<
+				std::pair<const Arc<M_>*, typename range<M_>::type>,
+				std::pair<const State<M_>*, const void*>
+			> key_type;
+
+	typedef std::vector<const State<M_>*> states_type;
+
+	key_type key;
+	states_type folded;
+
+	/**
+	 *	The only constructor.
+	 *
+	 *	@param	a_key
+	 *		State key
+	 */
+	merge_entry (const key_type& a_key):
+		key (a_key)
+	{
+	}
+
+};
+
+/**
+ *	Beam scores of queued states. Of the states that compete for a place in the
+ *	beam, the ones of the lowest scores get pruned first.
+ *	@{ */
+
+/**
+ *	Scores a state by the priority of its arc (prioritized alternatives that
+ *	come first are preferred).
+ */
+template <typename M_>
+long score_priority (const State<M_>* a_state)
+{
+	return - static_cast<long>(a_state -> get_arc(). get_priority());
+}
+
+/**
+ *	Scores a state by the length of the source range it has accepted.
+ */
+template <typename M_>
+long score_length (const State<M_>* a_state)
+{
+	return a_state -> get_range(). second - a_state -> get_range(). first;
+}
+
+/**	@} */
+
 /**
  *	The analysis state processor.
  */
@@ -136,6 +268,11 @@ public:
 	 */
 	typedef M_ model_type;
 
+	/**
+	 *	The beam scoring function type.
+	 */
+	typedef long (*score_type)(const State<M_>*);
+
 	/**
 	 *	The only constructor.
 	 *
@@ -146,7 +283,9 @@ public:
 	 */
 	Processor (const Node<M_>& a_entry_node,
 			const Label<M_>& a_label = Label<M_>()):
-		m_entry_arc (a_entry_node, unconditional<M_>(), atSimple, a_label)
+		m_entry_arc (a_entry_node, unconditional<M_>(), atSimple, a_label),
+		m_memoize (false), m_beam_width (0), m_beam_score (NULL),
+		m_max_traces (0), m_negated (false), m_merge (false)
 	{
 	}
 
@@ -166,6 +305,74 @@ public:
 		return m_observer;
 	}
 
+	/**
+	 *	Enable or disable memoization of sub-network invocations.
+	 *
+	 *	When enabled, invocations of the same node over the same source range
+	 *	and within the same environment are traversed only once: callers that
+	 *	arrive later get suspended, and each final state reached by the shared
+	 *	traversal is delivered to all of them.
+	 *
+	 *	@param	a_memoize
+	 *		Whether the memoization is enabled
+	 */
+	void set_memoization (const bool a_memoize)
+	{
+		m_memoize = a_memoize;
+	}
+
+	/**
+	 *	Limit the number of queued states per source position. When the limit
+	 *	gets exceeded, the state of the lowest score at that position is pruned
+	 *	off the processing queue and disposed of, so that the traversal is no
+	 *	longer exhaustive. Note that a negative assertion pruned that way never
+	 *	blocks its caller.
+	 *
+	 *	@param	a_width
+	 *		Beam width, or zero to disable the limit
+	 *	@param	a_score
+	 *		Beam scoring function
+	 */
+	void set_beam_width (const uint_t a_width,
+			const score_type a_score = &score_priority<M_>)
+	{
+		m_beam_width = a_width;
+		m_beam_score = a_score;
+	}
+
+	/**
+	 *	Limit the number of traces to be found. The traversal stops as soon as
+	 *	the limit is reached, unless negations have been entered (the traces
+	 *	found so far could still get blocked by them), in which case the extra
+	 *	traces get dropped once the traversal is over.
+	 *
+	 *	@param	a_max_traces
+	 *		Maximum number of traces, or zero to find them all
+	 */
+	void set_max_traces (const uint_t a_max_traces)
+	{
+		m_max_traces = a_max_traces;
+	}
+
+	/**
+	 *	Enable or disable merging of equivalent states.
+	 *
+	 *	When enabled, a state pushed for the same arc over the same source range
+	 *	as a state pushed earlier, that returns to the same invocation and has
+	 *	the same trace context in effect, is not processed by itself: it gets
+	 *	folded into the earlier state instead, so that ambiguity is packed
+	 *	rather than enumerated, and the Tracer unpacks the traces on demand.
+	 *	States are only merged until a negation is entered, and never while the
+	 *	memoization is enabled.
+	 *
+	 *	@param	a_merge
+	 *		Whether the merging is enabled
+	 */
+	void set_merging (const bool a_merge)
+	{
+		m_merge = a_merge;
+	}
+
 public:
 	/**
 	 *	Initialize the processor by setting a source range.
@@ -183,6 +390,7 @@ public:
 		m_C. second = a_to;
 		m_arc =& m_entry_arc;
 		m_state = NULL;
+		m_negated = false;
 		// Spawn an initial state and push it to the processing queue.
 		// NOTE: Storing the initial state pointer as the current state pointer
 		//		 allows to predefine some trace variables before running the
@@ -225,6 +433,13 @@ public:
 		m_queue. clear();
 		m_traced. clear();
 		m_deferred. clear();
+		m_memo_table. clear();
+		m_memo_index. clear();
+		m_memo_results. clear();
+		m_children. clear();
+		m_beam. clear();
+		m_merge_table. clear();
+		m_merged. clear();
 		m_observer. reset();
 	}
 
@@ -244,6 +459,31 @@ public:
 		return m_traced;
 	}
 
+	/**
+	 *	Get the number of found traces, counting each of the traces packed by
+	 *	merging separately.
+	 *
+	 *	@return
+	 *		Number of found traces
+	 */
+	uint_t get_trace_count () const;
+
+	/**
+	 *	Get the states that have been folded into the given one by merging.
+	 *
+	 *	@param	a_state
+	 *		State pointer
+	 *	@return
+	 *		Pointer to the folded states container or NULL
+	 */
+	const typename merge_entry<M_>::states_type* get_merged (
+			const State<M_>* a_state) const
+	{
+		const typename merged_type::const_iterator found =
+			m_merged. find(a_state);
+		return (found != m_merged. end()) ? & found -> second. folded : NULL;
+	}
+
 	/**
 	 *	Spawn a new descendant state for the given source range.
 	 *
@@ -258,10 +498,34 @@ public:
 		const typename iterator<M_>::type& a_to)
 	{
 		return Base<Processor<M_>, M_>::test_lr(m_arc, a_from)
-			?  new(*this) StateCommon<M_>(m_state, m_arc, a_from, a_to)
+			?  adopt(new(*this) StateCommon<M_>(m_state, m_arc, a_from, a_to))
 			:  NULL;
 	}
 
+	/**
+	 *	Try to evict the last allocated segment from the pool. The memoized
+	 *	invocations that depend on the segment get forgotten.
+	 *
+	 *	@param	a_ptr
+	 *		Segment pointer
+	 *	@param	a_size
+	 *		Segment size
+	 *	@return
+	 *		Whether the segment has been evicted
+	 */
+	bool evict (const void* a_ptr, const std::size_t a_size)
+	{
+		if (! pool<M_>::type::evict(a_ptr, a_size))
+		{
+			return false;
+		}
+		if (m_memoize)
+		{
+			forget(static_cast<const State<M_>*>(a_ptr));
+		}
+		return true;
+	}
+
 	/**
 	 *	Push a descendant state into the processing queue.
 	 *
@@ -280,10 +544,18 @@ public:
 			m_deferred. push_back(a_descendant);
 			m_observer. notify(evDEFER, a_descendant);
 		}
+		else if (m_merge && merge(a_descendant))
+		{
+			m_observer. notify(evMERGE, a_descendant);
+		}
 		else
 		{
 			m_queue. push_back(a_descendant);
 			m_observer. notify(evPUSH, a_descendant);
+			if (m_beam_width != 0)
+			{
+				narrow(a_descendant);
+			}
 		}
 	}
 
@@ -326,12 +598,222 @@ private:
 	template <typename Container_>
 	void filter (const State<M_>* a_ancestor, Container_& a_container);
 
+	/**
+	 *	Block all callers suspended on memoized invocations that descend from
+	 *	the given ancestor.
+	 *
+	 *	@param	a_ancestor
+	 *		Ancestor state
+	 */
+	void filter_suspended (const State<M_>* a_ancestor);
+
+	/**
+	 *	Check whether a state descends from the given ancestor, taking into
+	 *	account all the callers of the memoized invocations it belongs to.
+	 *
+	 *	@param	a_state
+	 *		Descendant state candidate
+	 *	@param	a_ancestor
+	 *		Ancestor state
+	 */
+	bool descends (const State<M_>* a_state, const State<M_>* a_ancestor)
+		const;
+
+	/**
+	 *	Check whether a state descends from the given ancestor, relying on the
+	 *	address order of states. The walk stops as soon as it joins the chain
+	 *	of ancestors walked through for the previous state.
+	 *
+	 *	@param	a_state
+	 *		Descendant state candidate
+	 *	@param	a_ancestor
+	 *		Ancestor state
+	 *	@param	a_last
+	 *		The outcome for the previous state
+	 */
+	bool inherits (const State<M_>* a_state, const State<M_>* a_ancestor,
+			const bool a_last);
+
+	/**
+	 *	Register the current (just entered) state in the memoization table. If
+	 *	an equivalent invocation is already there, the state gets suspended on
+	 *	it, and all the final states reached by the invocation so far get
+	 *	delivered to the state.
+	 *
+	 *	@return
+	 *		Whether the current state has been suspended
+	 */
+	bool suspend ();
+
+	/**
+	 *	Deliver the current (final) state to all the callers suspended on the
+	 *	given invocation.
+	 *
+	 *	@param	a_entry
+	 *		Invocation entry state
+	 *	@return
+	 *		Whether the caller that performed the invocation has been blocked
+	 */
+	bool resume (const State<M_>* a_entry);
+
+	/**
+	 *	Stop sharing the memoized invocation that has been performed by the
+	 *	given entry state or has reached the given final state.
+	 *
+	 *	@param	a_state
+	 *		Evicted state
+	 */
+	void forget (const State<M_>* a_state);
+
+	/**
+	 *	Dispose of a state that has been removed from a state container before
+	 *	having spawned any descendants.
+	 *
+	 *	@param	a_state
+	 *		Defunct state
+	 */
+	void discard (const State<M_>* a_state);
+
+	/**
+	 *	Account a newly created state as a live child of its ancestor and, for
+	 *	split states, of the caller it has been split from.
+	 *
+	 *	@param	a_state
+	 *		Newly created state
+	 *	@return
+	 *		The same state pointer
+	 */
+	template <typename State_>
+	State_* adopt (State_* a_state)
+	{
+		if (! m_memoize)
+		{
+			if (const State<M_>* ancestor = a_state -> get_ancestor())
+			{
+				++ m_children[ancestor];
+			}
+			if (const State<M_>* caller = a_state -> get_caller())
+			{
+				++ m_children[caller];
+			}
+		}
+		return a_state;
+	}
+
+	/**
+	 *	Release a live child of the given state.
+	 *
+	 *	@return
+	 *		Whether the state has been left with no live children
+	 */
+	bool release (const State<M_>* a_state);
+
+	/**
+	 *	Dispose of a state that has no live children, along with each of its
+	 *	ancestors (and callers) left with no live children.
+	 *
+	 *	@param	a_state
+	 *		Defunct state
+	 */
+	void retire (const State<M_>* a_state);
+
+	/**
+	 *	Spawn a shared split state that delivers a final state to a suspended
+	 *	caller, and push it to the processing queue.
+	 *
+	 *	@param	a_entry
+	 *		Entry state of the suspended caller
+	 *	@param	a_result
+	 *		Final state reached by the memoized invocation
+	 */
+	void share (const State<M_>* a_entry, const State<M_>* a_result);
+
+	/**
+	 *	Add a just queued state to the beam at its source position, and prune
+	 *	the state of the lowest score if the beam width gets exceeded.
+	 *
+	 *	@param	a_state
+	 *		Queued state
+	 */
+	void narrow (const State<M_>* a_state);
+
+	/**
+	 *	Remove a state that leaves the processing queue from the beam.
+	 *
+	 *	@param	a_state
+	 *		Dequeued state
+	 */
+	void unbeam (const State<M_>* a_state);
+
+	/**
+	 *	Register a state that is about to be queued for merging. If an
+	 *	equivalent state has been registered already, the state gets folded
+	 *	into it.
+	 *
+	 *	@param	a_state
+	 *		Descendant state
+	 *	@return
+	 *		Whether the state has been folded
+	 */
+	bool merge (const State<M_>* a_state);
+
+	/**
+	 *	Stop merging states into the given (defunct) state, and retire all the
+	 *	states folded into it.
+	 *
+	 *	@param	a_state
+	 *		Defunct state
+	 */
+	void unmerge (const State<M_>* a_state);
+
+	/**
+	 *	Find the nearest state on the chain of ancestors (starting from the
+	 *	given state itself) that other states have been folded into.
+	 *
+	 *	@param	a_state
+	 *		State pointer or NULL
+	 *	@return
+	 *		Found state pointer or NULL
+	 */
+	const State<M_>* find_merged (const State<M_>* a_state) const;
+
 private:
 	/**
 	 *	The container type for deferred states.
 	 */
 	typedef std::vector<const State<M_>*> deferred_type;
 
+	/**
+	 *	The container types for memoized invocations.
+	 *	@{ */
+	typedef std::map<
+				typename memo_entry<M_>::key_type,
+				const State<M_>*
+			> memo_table_type;
+	typedef std::map<const State<M_>*, memo_entry<M_> > memo_index_type;
+	typedef std::map<const State<M_>*, const State<M_>*> memo_results_type;
+	/**	@} */
+
+	/**
+	 *	The container type for live child counts.
+	 */
+	typedef boost::unordered_map<const State<M_>*, uint_t> children_type;
+
+	/**
+	 *	The container type for queued states by source position.
+	 */
+	typedef std::map<typename iterator<M_>::type, deferred_type> beam_type;
+
+	/**
+	 *	The container types for merged states.
+	 *	@{ */
+	typedef std::map<
+				typename merge_entry<M_>::key_type,
+				const State<M_>*
+			> merge_table_type;
+	typedef std::map<const State<M_>*, merge_entry<M_> > merged_type;
+	/**	@} */
+
 	const Arc<M_> m_entry_arc;					/**< entry arc */
 	std::deque<State<M_>*> m_queue;				/**< processing queue */
 	traced_type m_traced;						/**< found traces */
@@ -340,6 +822,22 @@ private:
 	const Arc<M_>* m_arc;						/**< current arc pointer */
 	using Base<Processor<M_>, M_>::m_state;		/**< current state pointer */
 	typename observer<M_>::type m_observer;		/**< observer */
+	bool m_memoize;								/**< memoization flag */
+	memo_table_type m_memo_table;				/**< shared invocations */
+	memo_index_type m_memo_index;				/**< memoized invocations */
+	memo_results_type m_memo_results;			/**< ... by final state */
+	children_type m_children;					/**< live child counts */
+	deferred_type m_defunct;					/**< states to dispose of */
+	deferred_type m_path;						/**< last walked ancestors */
+	deferred_type m_walked;						/**< ... being walked */
+	uint_t m_beam_width;						/**< beam width */
+	score_type m_beam_score;					/**< beam scoring function */
+	beam_type m_beam;							/**< beam states */
+	uint_t m_max_traces;						/**< trace limit */
+	bool m_negated;								/**< negations entered */
+	bool m_merge;								/**< merging flag */
+	merge_table_type m_merge_table;				/**< merging states */
+	merged_type m_merged;						/**< ... by state */
 
 };
 
@@ -386,23 +884,91 @@ struct spawner
 
 };
 
+/**
+ *	ancestry<M_> is an auxiliary walker over the actual trace of a state. Unlike
+ *	the plain chain of ancestors, it takes into account that the final states of
+ *	a memoized invocation are shared by several callers: on return from such an
+ *	invocation the entry state of the caller the walk has come from gets
+ *	substituted for the entry state that performed the invocation.
+ */
 template <typename M_>
-uint_t Processor<M_>::run ()
+class ancestry
 {
-	uint_t total_iteration_count = 0;
-
-	typedef spawner<M_> spawner_type;
-	typedef std::vector<spawner_type> spawners_type;
-	spawners_type spawners;
-
-	// The outer loop.
-	while (true)
+public:
+	/**
+	 *	The only constructor.
+	 *
+	 *	@param	a_state
+	 *		Initial state
+	 */
+	ancestry (const State<M_>* a_state):
+		m_state (a_state), m_returned (false)
 	{
-		// Run the inner loop.
-		total_iteration_count += run0();
+	}
 
-		// Check if there are any deferred states.
-		if (m_deferred. empty())
+	/**
+	 *	Check whether the current state is an invocation entry state, and the
+	 *	walked trace has already returned from that invocation.
+	 */
+	bool is_returned () const
+	{
+		return m_returned;
+	}
+
+	/**
+	 *	Move to the next ancestor.
+	 *
+	 *	@return
+	 *		The next ancestor state pointer or NULL
+	 */
+	const State<M_>* next ()
+	{
+		const State<M_>* entry = m_state -> get_entry();
+		m_state = m_state -> get_ancestor();
+		if (entry != NULL)
+		{
+			m_entries. push_back(
+					std::make_pair(m_state -> get_callee(), entry));
+		}
+
+		m_returned =
+			! m_entries. empty() && m_entries. back(). first == m_state;
+		if (m_returned)
+		{
+			m_state = m_entries. back(). second;
+			m_entries. pop_back();
+		}
+		return m_state;
+	}
+
+private:
+	typedef std::vector<
+				std::pair<const State<M_>*, const State<M_>*>
+			> entries_type;
+
+	const State<M_>* m_state;
+	bool m_returned;
+	entries_type m_entries;
+
+};
+
+template <typename M_>
+uint_t Processor<M_>::run ()
+{
+	uint_t total_iteration_count = 0;
+
+	typedef spawner<M_> spawner_type;
+	typedef std::vector<spawner_type> spawners_type;
+	spawners_type spawners;
+
+	// The outer loop.
+	while (true)
+	{
+		// Run the inner loop.
+		total_iteration_count += run0();
+
+		// Check if there are any deferred states.
+		if (m_deferred. empty())
 		{
 			break;
 		}
@@ -471,6 +1037,10 @@ uint_t Processor<M_>::run ()
 			{
 				m_queue. push_back(j -> state);
 			}
+			else
+			{
+				discard(j -> state);
+			}
 		}
 
 		// Save top candidates from other entanglement groups for later
@@ -486,12 +1056,27 @@ uint_t Processor<M_>::run ()
 			{
 				m_deferred. push_back(j -> state);
 			}
+			else
+			{
+				discard(j -> state);
+			}
 		}
 
 		// Clean up.
 		spawners. clear();
 	}
 
+	// Drop the traces beyond the limit.
+	if (m_max_traces != 0 && m_traced. size() > m_max_traces)
+	{
+		for (typename traced_type::iterator i =
+				m_traced. begin() + m_max_traces; i != m_traced. end(); ++ i)
+		{
+			discard(*i);
+		}
+		m_traced. resize(m_max_traces);
+	}
+
 	return total_iteration_count;
 }
 
@@ -503,6 +1088,7 @@ uint_t Processor<M_>::run0 ()
 	bool has_negations = false;
 	const State<M_>* callee;
 	const State<M_>* caller;
+	const State<M_>* result;
 
 	// The inner loop.
 	while (! m_queue. empty())
@@ -532,67 +1118,114 @@ uint_t Processor<M_>::run0 ()
 			m_queue. pop_back();
 		}
 		m_observer. notify(evPULL, m_state);
-
-		// Try to enter the state (execute semantic actions).
-		if (! enter(*this))
+		if (m_beam_width != 0)
 		{
-			m_observer. notify(evDENY, m_state);
-			rollback(*this, m_state);
-			continue;
+			unbeam(m_state);
 		}
 
-		m_observer. notify(evENTRY, m_state);
+		// Whatever gets allocated from now on must reside above the current
+		// state (and in the order of allocation), so that segments reclaimed
+		// below it could not be reused for its descendants.
+		pool<M_>::type::set_floor(m_state);
 
-		// Check whether the state corresponds to an final node.
-		if (m_state -> get_arc(). get_target(). is_final())
+		// Split states spawned for suspended callers have nothing to enter, so
+		// they move on to the arc enumeration phase at once.
+		if (m_memoize && m_state -> is_split())
+		{
+			m_observer. notify(evSPLIT, m_state);
+		}
+		else
 		{
-			// Get the callee and the caller state pointers.
-			callee = m_state -> get_callee();
-			caller = (callee != NULL) ? callee -> get_ancestor() : NULL;
+			// Try to enter the state (execute semantic actions).
+			if (! enter(*this))
+			{
+				m_observer. notify(evDENY, m_state);
+				retire(m_state);
+				continue;
+			}
+
+			m_observer. notify(evENTRY, m_state);
 
-			// If there is no caller state then we're on the surface, and
-			// therefore another trace is found.
-			if (caller == NULL)
+			// Check whether an equivalent invocation is already under way.
+			if (m_memoize && suspend())
 			{
-				m_traced. push_back(m_state);
-				m_observer. notify(evTRACE, m_state);
 				continue;
 			}
 
-			// Create a split state of the type that corresponds to the type of
-			// the callee arc.
-			switch (callee -> get_arc_type())
+			// Check whether the state corresponds to an final node.
+			if (m_state -> get_arc(). get_target(). is_final())
 			{
-			case atSimple:
-				// This should never happen.
-				throw std::logic_error("call from simple arc");
-
-			// NOTE: We drop the original state pointer here and move on to the
-			//		 arc enumeration phase with the split state pointer.
-			case atInvoke:
-				m_state = new(*this) StateSplitShifted<M_>(caller, m_state);
-				break;
+				// Get the callee and the caller state pointers.
+				callee = m_state -> get_callee();
+				caller = (callee != NULL) ? callee -> get_ancestor() : NULL;
 
-			case atExtend:
-				m_state = new(*this) StateSplitExtended<M_>(caller, m_state);
-				break;
+				// Deliver the result of a memoized invocation to the suspended
+				// callers, and drop it if the original caller is blocked.
+				if (m_memoize && callee != NULL && resume(callee))
+				{
+					continue;
+				}
 
-			case atPositive:
-				m_state = new(*this) StateSplit<M_>(caller);
-				break;
+				// If there is no caller state then we're on the surface, and
+				// therefore another trace is found.
+				if (caller == NULL)
+				{
+					m_traced. push_back(m_state);
+					m_observer. notify(evTRACE, m_state);
+					if (m_traced. size() == m_max_traces && ! m_negated)
+					{
+						m_queue. clear();
+						m_deferred. clear();
+						m_beam. clear();
+					}
+					continue;
+				}
 
-			case atNegative:
-				// The caller state becomes blocked if a return from a negative
-				// statement call happens.
-				const_cast<State<M_>*>(caller) -> block();
-				m_observer. notify(evBLOCK, caller);
-				filter(caller, m_queue);
-				filter(caller, m_traced);
-				filter(caller, m_deferred);
-				continue;
-			}
+				// Create a split state of the type that corresponds to the type
+				// of the callee arc.
+				switch (callee -> get_arc_type())
+				{
+				case atSimple:
+					// This should never happen.
+					throw std::logic_error("call from simple arc");
+
+				// NOTE: We drop the original state pointer here and move on to
+				//		 the arc enumeration phase with the split state pointer.
+				case atInvoke:
+					m_state = adopt(
+						new(*this) StateSplitShifted<M_>(caller, m_state));
+					break;
 
-			m_observer. notify(evSPLIT, m_state);
+				case atExtend:
+					m_state = adopt(
+						new(*this) StateSplitExtended<M_>(caller, m_state));
+					break;
+
+				// NOTE: The final state of an assertion is not an ancestor of
+				//		 the split state, so it is of no use anymore.
+				case atPositive:
+					result = m_state;
+					m_state = adopt(new(*this) StateSplit<M_>(caller));
+					retire(result);
+					break;
+
+				case atNegative:
+					// The caller state becomes blocked if a return from a
+					// negative statement call happens.
+					const_cast<State<M_>*>(caller) -> block();
+					m_observer. notify(evBLOCK, caller);
+					filter(caller, m_queue);
+					filter(caller, m_traced);
+					filter(caller, m_deferred);
+					if (m_memoize)
+					{
+						filter_suspended(caller);
+					}
+					continue;
+				}
+
+				m_observer. notify(evSPLIT, m_state);
+			}
 		}
 
 		// NOTE: State<M_>::get_bunch() and State<M_>::get_range() are inlinable
@@ -620,10 +1253,19 @@ uint_t Processor<M_>::run0 ()
 			if (arc_type == atNegative)
 			{
 				has_negations = true;
+				m_negated = true;
 			}
 		}
 
-		rollback(*this, m_state);
+		// A state that has not spawned any descendants is defunct.
+		if (m_memoize)
+		{
+			rollback(*this, m_state);
+		}
+		else if (m_children. find(m_state) == m_children. end())
+		{
+			retire(m_state);
+		}
 	}
 
 	return inner_iteration_count;
@@ -634,33 +1276,575 @@ template <typename Container_>
 void Processor<M_>::filter (const State<M_>* a_ancestor,
 		Container_& a_container)
 {
+	// NOTE: The remaining states get moved towards the beginning of the
+	//		 container in a single pass, which keeps their order.
+	typename Container_::iterator j = a_container. begin();
+	bool found = false;
+	m_path. clear();
 	for (typename Container_::iterator i = a_container. begin();
 			i != a_container. end(); ++ i)
 	{
-		// NOTE: The scan below is computationally expensive, but the outcome
-		//		 happens to be worth it. It effectively utilizes the fact that
-		//		 ancestor's address is always less than descendant's.
-		const State<M_>* p = *i;
-		while (p > a_ancestor)
-		{
-			p = p -> get_ancestor();
-		}
+		// NOTE: The address order of states does not hold for memoized
+		//		 invocations, which require a complete walk.
+		found = m_memoize
+			? descends(*i, a_ancestor)
+			: inherits(*i, a_ancestor, found);
 
 		// If a descendant was found, then
-		if (p == a_ancestor)
+		if (found)
 		{
+			if (m_beam_width != 0)
+			{
+				unbeam(*i);
+			}
+
 			// 1) .. block the descendant
 			const_cast<State<M_>*>(*i) -> block();
 			m_observer. notify(evBLOCK, *i);
 
 			// 2) .. remove the descendant from the container
-			const typename Container_::difference_type index =
-				i - a_container. begin();
-			a_container. erase(i);
-			i = a_container. begin();
-			std::advance(i, index - 1);
+			discard(*i);
+		}
+		else
+		{
+			*j ++ = *i;
 		}
 	}
+	a_container. erase(j, a_container. end());
+}
+
+template <typename M_>
+void Processor<M_>::filter_suspended (const State<M_>* a_ancestor)
+{
+	typedef typename memo_entry<M_>::states_type states_type;
+
+	for (typename memo_index_type::iterator i = m_memo_index. begin();
+			i != m_memo_index. end(); ++ i)
+	{
+		memo_entry<M_>& m = i -> second;
+		bool live = false;
+
+		// Check the caller that has performed the invocation.
+		if (! m. orphaned)
+		{
+			m. orphaned = descends(i -> first -> get_ancestor(), a_ancestor);
+			live = ! m. orphaned;
+		}
+
+		// Check the suspended callers.
+		for (typename states_type::const_iterator c = m. callers. begin();
+				c != m. callers. end(); ++ c)
+		{
+			if ((*c) -> is_blocked())
+			{
+				continue;
+			}
+			if (descends(*c, a_ancestor))
+			{
+				const_cast<State<M_>*>(*c) -> block();
+				m_observer. notify(evBLOCK, *c);
+			}
+			else
+			{
+				live = true;
+			}
+		}
+
+		// An invocation with no live callers left might have been cut off, so
+		// it must not be shared anymore.
+		if (! live)
+		{
+			m_memo_table. erase(m. key);
+		}
+	}
+}
+
+template <typename M_>
+bool Processor<M_>::descends (const State<M_>* a_state,
+		const State<M_>* a_ancestor) const
+{
+	typedef typename memo_entry<M_>::states_type states_type;
+
+	ancestry<M_> a(a_state);
+	for (const State<M_>* p = a_state; p != NULL; p = a. next())
+	{
+		if (p == a_ancestor || p -> is_blocked())
+		{
+			return true;
+		}
+
+		// NOTE: A memoized invocation that has not returned yet on the walked
+		//		 trace works for all of its callers at once.
+		if (! a. is_returned())
+		{
+			const typename memo_index_type::const_iterator found =
+				m_memo_index. find(p);
+			if (found != m_memo_index. end())
+			{
+				const memo_entry<M_>& m = found -> second;
+				if	(	! m. orphaned
+					&&	! descends(p -> get_ancestor(), a_ancestor)
+					)
+				{
+					return false;
+				}
+				for (typename states_type::const_iterator c =
+						m. callers. begin(); c != m. callers. end(); ++ c)
+				{
+					if (! (*c) -> is_blocked() && ! descends(*c, a_ancestor))
+					{
+						return false;
+					}
+				}
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+template <typename M_>
+bool Processor<M_>::suspend ()
+{
+	typedef typename memo_entry<M_>::states_type states_type;
+
+	// Only invocations are subject to memoization.
+	const arc_type_t arc_type = m_state -> get_arc_type();
+	if (arc_type != atInvoke && arc_type != atExtend)
+	{
+		return false;
+	}
+
+	const typename memo_entry<M_>::key_type key(
+		std::make_pair(& m_state -> get_arc(). get_target(),
+				m_state -> get_range()),
+		Base<Processor<M_>, M_>::memo_digest(m_state)
+	);
+
+	// If this is a new invocation, then register it and carry on.
+	const std::pair<typename memo_table_type::iterator, bool> found =
+		m_memo_table. insert(
+				typename memo_table_type::value_type(key, m_state));
+	if (found. second)
+	{
+		m_memo_index. insert(typename memo_index_type::value_type(
+				m_state, memo_entry<M_>(key)));
+		return false;
+	}
+
+	// Otherwise suspend the state on the invocation and deliver all the final
+	// states reached by the invocation so far.
+	memo_entry<M_>& m = m_memo_index. find(found. first -> second) -> second;
+	m. callers. push_back(m_state);
+	m_observer. notify(evSUSPEND, m_state);
+	for (typename states_type::const_iterator r = m. results. begin();
+			r != m. results. end(); ++ r)
+	{
+		share(m_state, *r);
+	}
+	return true;
+}
+
+template <typename M_>
+bool Processor<M_>::resume (const State<M_>* a_entry)
+{
+	typedef typename memo_entry<M_>::states_type states_type;
+
+	const typename memo_index_type::iterator found =
+		m_memo_index. find(a_entry);
+	if (found == m_memo_index. end())
+	{
+		return false;
+	}
+
+	// Record the final state for the callers to come, and deliver it to the
+	// callers suspended so far.
+	memo_entry<M_>& m = found -> second;
+	m. results. push_back(m_state);
+	m_memo_results. insert(
+			typename memo_results_type::value_type(m_state, a_entry));
+	for (typename states_type::const_iterator c = m. callers. begin();
+			c != m. callers. end(); ++ c)
+	{
+		if (! (*c) -> is_blocked())
+		{
+			share(*c, m_state);
+		}
+	}
+	return m. orphaned;
+}
+
+template <typename M_>
+bool Processor<M_>::inherits (const State<M_>* a_state,
+		const State<M_>* a_ancestor, const bool a_last)
+{
+	// NOTE: Neighbouring states in a container usually share most of their
+	//		 ancestors. All the states on the last walked chain (kept in the
+	//		 increasing address order) have the same outcome, so that a walk
+	//		 that joins the chain takes the outcome over. Each state gets on
+	//		 and off the chain at most once per walk, which keeps the scan of
+	//		 a container linear in the number of distinct states walked.
+	bool found = a_last;
+	for (const State<M_>* p = a_state; ; )
+	{
+		if (p <= a_ancestor)
+		{
+			found = (p == a_ancestor);
+			m_path. clear();
+			break;
+		}
+		while (! m_path. empty() && m_path. back() > p)
+		{
+			m_path. pop_back();
+		}
+		if (! m_path. empty() && m_path. back() == p)
+		{
+			break;
+		}
+		m_walked. push_back(p);
+
+		// NOTE: The callee of a state is not necessarily its ancestor, yet
+		//		 the ancestor chains of both coincide below the address of the
+		//		 callee, so that the walk may skip the entire invocation body.
+		const State<M_>* callee = p -> get_callee();
+		p = (callee < p && callee > a_ancestor && ! p -> is_blocked())
+			? callee : p -> get_ancestor();
+	}
+
+	m_path. insert(m_path. end(), m_walked. rbegin(), m_walked. rend());
+	m_walked. clear();
+	return found;
+}
+
+template <typename M_>
+void Processor<M_>::narrow (const State<M_>* a_state)
+{
+	deferred_type& states = m_beam[a_state -> get_range(). second];
+	states. push_back(a_state);
+	if (states. size() <= m_beam_width)
+	{
+		return;
+	}
+
+	// Find the state of the lowest score, which is the newcomer unless some
+	// state in the beam scores strictly lower.
+	typename deferred_type::iterator worst = states. end() - 1;
+	long score = m_beam_score(*worst);
+	for (typename deferred_type::iterator i = states. begin();
+			i != states. end() - 1; ++ i)
+	{
+		const long s = m_beam_score(*i);
+		if (s < score)
+		{
+			score = s;
+			worst = i;
+		}
+	}
+
+	// Prune the state off the beam and the processing queue.
+	const State<M_>* p = *worst;
+	states. erase(worst);
+	m_queue. erase(
+		std::find(m_queue. rbegin(), m_queue. rend(), p). base() - 1);
+	m_observer. notify(evPRUNE, p);
+
+	// NOTE: The current state may be left with no live children here, but it
+	//		 is still being processed, and gets retired at the end of the step.
+	if (m_memoize || m_state == NULL)
+	{
+		discard(p);
+	}
+	else
+	{
+		++ m_children[m_state];
+		discard(p);
+		release(m_state);
+	}
+}
+
+template <typename M_>
+void Processor<M_>::unbeam (const State<M_>* a_state)
+{
+	const typename beam_type::iterator i =
+		m_beam. find(a_state -> get_range(). second);
+	if (i == m_beam. end())
+	{
+		return;
+	}
+
+	const typename deferred_type::iterator j =
+		std::find(i -> second. begin(), i -> second. end(), a_state);
+	if (j != i -> second. end())
+	{
+		i -> second. erase(j);
+		if (i -> second. empty())
+		{
+			m_beam. erase(i);
+		}
+	}
+}
+
+template <typename M_>
+bool Processor<M_>::merge (const State<M_>* a_state)
+{
+	// NOTE: States queued after a negation has been entered might get blocked
+	//		 along with their descendants, which would cut off the states folded
+	//		 into them. Assertions return to the ancestors of their entry states
+	//		 rather than pass through them, so that they can not be folded.
+	const arc_type_t arc_type = a_state -> get_arc_type();
+	if (m_memoize || m_negated || arc_type == atPositive
+			|| arc_type == atNegative)
+	{
+		return false;
+	}
+
+	const State<M_>* ancestor = a_state -> get_ancestor();
+	const typename merge_entry<M_>::key_type key(
+		std::make_pair(& a_state -> get_arc(), a_state -> get_range()),
+		std::make_pair(
+			(ancestor != NULL) ? ancestor -> get_callee() : NULL,
+			Base<Processor<M_>, M_>::memo_digest(a_state))
+	);
+
+	// If this is a new state, then register it and carry on.
+	const std::pair<typename merge_table_type::iterator, bool> found =
+		m_merge_table. insert(
+				typename merge_table_type::value_type(key, a_state));
+	if (found. second)
+	{
+		m_merged. insert(typename merged_type::value_type(
+				a_state, merge_entry<M_>(key)));
+		return false;
+	}
+
+	// Otherwise fold the state into the equivalent one, unless the latter is
+	// its ancestor (which would make the folded traces loop).
+	const State<M_>* target = found. first -> second;
+	m_path. clear();
+	if (inherits(a_state, target, false))
+	{
+		return false;
+	}
+	m_merged. find(target) -> second. folded. push_back(a_state);
+	return true;
+}
+
+template <typename M_>
+void Processor<M_>::unmerge (const State<M_>* a_state)
+{
+	const typename merged_type::iterator found = m_merged. find(a_state);
+	if (found == m_merged. end())
+	{
+		return;
+	}
+
+	// NOTE: The folded states have no descendants, but keep their ancestors
+	//		 alive until now.
+	const merge_entry<M_>& m = found -> second;
+	m_merge_table. erase(m. key);
+	m_defunct. insert(m_defunct. end(), m. folded. begin(), m. folded. end());
+	m_merged. erase(found);
+}
+
+template <typename M_>
+uint_t Processor<M_>::get_trace_count () const
+{
+	if (m_merged. empty())
+	{
+		return static_cast<uint_t>(m_traced. size());
+	}
+
+	// NOTE: The number of traces that lead to a state others have been folded
+	//		 into is the sum of the numbers of traces that lead to each of the
+	//		 states' ancestors. The counts get cached for such states, and the
+	//		 ones not yet known are resolved by means of an explicit stack, as
+	//		 the chains may be arbitrarily long.
+	typedef std::map<const State<M_>*, uint_t> counts_type;
+	typedef typename merge_entry<M_>::states_type states_type;
+	counts_type counts;
+	counts[NULL] = 1;
+	deferred_type stack;
+	uint_t total = 0;
+	for (typename traced_type::const_iterator t = m_traced. begin();
+			t != m_traced. end(); ++ t)
+	{
+		const State<M_>* merged = find_merged(*t);
+		stack. push_back(merged);
+		while (! stack. empty())
+		{
+			const State<M_>* p = stack. back();
+			if (counts. find(p) != counts. end())
+			{
+				stack. pop_back();
+				continue;
+			}
+
+			const states_type& folded = m_merged. find(p) -> second. folded;
+			bool ready = true;
+			uint_t count = 0;
+			for (std::size_t i = 0; i <= folded. size(); ++ i)
+			{
+				const State<M_>* q = find_merged(
+					((i == 0) ? p : folded[i - 1]) -> get_ancestor());
+				const typename counts_type::const_iterator found =
+					counts. find(q);
+				if (found == counts. end())
+				{
+					stack. push_back(q);
+					ready = false;
+				}
+				else
+				{
+					count += found -> second;
+				}
+			}
+
+			if (ready)
+			{
+				counts[p] = count;
+				stack. pop_back();
+			}
+		}
+		total += counts[merged];
+	}
+	return total;
+}
+
+template <typename M_>
+const State<M_>* Processor<M_>::find_merged (const State<M_>* a_state) const
+{
+	const State<M_>* p = a_state;
+	while (p != NULL && m_merged. find(p) == m_merged. end())
+	{
+		p = p -> get_ancestor();
+	}
+	return p;
+}
+
+template <typename M_>
+void Processor<M_>::forget (const State<M_>* a_state)
+{
+	const State<M_>* entry = a_state;
+
+	// A final state is only needed for the callers to come.
+	const typename memo_results_type::iterator result =
+		m_memo_results. find(a_state);
+	if (result != m_memo_results. end())
+	{
+		entry = result -> second;
+		m_memo_results. erase(result);
+	}
+
+	const typename memo_index_type::iterator found = m_memo_index. find(entry);
+	if (found == m_memo_index. end())
+	{
+		return;
+	}
+
+	// NOTE: The table might already refer to another invocation with the
+	//		 same key.
+	const typename memo_table_type::iterator shared =
+		m_memo_table. find(found -> second. key);
+	if (shared != m_memo_table. end() && shared -> second == entry)
+	{
+		m_memo_table. erase(shared);
+	}
+
+	// An evicted entry state has no callers, and will never return.
+	if (entry == a_state)
+	{
+		m_memo_index. erase(found);
+	}
+}
+
+template <typename M_>
+void Processor<M_>::discard (const State<M_>* a_state)
+{
+	if (m_memoize)
+	{
+		return;
+	}
+
+	// NOTE: Blocked states are detached from their ancestors, which therefore
+	//		 can not be released.
+	if (a_state -> is_blocked())
+	{
+		dispose(*this, a_state);
+	}
+	else
+	{
+		retire(a_state);
+	}
+}
+
+template <typename M_>
+void Processor<M_>::retire (const State<M_>* a_state)
+{
+	// NOTE: Memoized invocations keep track of states across traces, so that
+	//		 only the tail of the pool can be safely rolled back.
+	if (m_memoize)
+	{
+		rollback(*this, a_state);
+		return;
+	}
+
+	m_defunct. push_back(a_state);
+	while (! m_defunct. empty())
+	{
+		const State<M_>* p = m_defunct. back();
+		const State<M_>* ancestor = p -> get_ancestor();
+		const State<M_>* caller = p -> get_caller();
+		m_defunct. pop_back();
+		if (! m_merged. empty())
+		{
+			unmerge(p);
+		}
+		dispose(*this, p);
+
+		if (caller != NULL && release(caller))
+		{
+			m_defunct. push_back(caller);
+		}
+		if (ancestor != NULL && release(ancestor))
+		{
+			m_defunct. push_back(ancestor);
+		}
+	}
+}
+
+template <typename M_>
+bool Processor<M_>::release (const State<M_>* a_state)
+{
+	const typename children_type::iterator found = m_children. find(a_state);
+	assert(found != m_children. end());
+	if (-- found -> second > 0)
+	{
+		return false;
+	}
+	m_children. erase(found);
+	return true;
+}
+
+template <typename M_>
+void Processor<M_>::share (const State<M_>* a_entry,
+		const State<M_>* a_result)
+{
+	State<M_>* split;
+	if (a_entry -> get_arc_type() == atExtend)
+	{
+		split = new(*this) StateSplitShared<M_, StateSplitExtended<M_> >(
+				a_entry -> get_ancestor(), a_result, a_entry);
+	}
+	else
+	{
+		split = new(*this) StateSplitShared<M_>(
+				a_entry -> get_ancestor(), a_result, a_entry);
+	}
+
+	// NOTE: Split states never get deferred since their entanglement (if any)
+	//		 has been resolved before the invocation.
+	m_queue. push_back(split);
+	m_observer. notify(evPUSH, split);
 }
 
 /******************************************************************************/
@@ -36,7 +36,9 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  *	        |
  *	        \-- StateSplitShifted
  *	              |
- *	              \-- StateSplitExtended
+ *	              |-- StateSplitExtended
+ *	              |
+ *	              \-- StateSplitShared
  *
  */
 
@@ -113,6 +115,15 @@ public:
 		return get_arc(). get_type();
 	}
 
+	// NOTE: The 'get_entry' method returns the invocation entry state that the
+	//		 ancestor chain of a shifted split state has to pass through on its
+	//		 way back to the caller. It differs from the callee of the shift
+	//		 only for the split states produced by memoized invocations.
+	virtual const State<M_>* get_entry () const
+	{
+		return NULL;
+	}
+
 	virtual std::size_t size () const = 0;
 
 protected:
@@ -333,6 +344,11 @@ public:
 		return atSimple;
 	}
 
+	const State<M_>* get_entry () const
+	{
+		return m_shift -> get_callee();
+	}
+
 	std::size_t size () const
 	{
 		return sizeof(StateSplitShifted<M_>);
@@ -376,6 +392,39 @@ private:
 
 };
 
+/**
+ *	A derivative object representing shifted split states that deliver a result
+ *	of a memoized invocation to a caller that did not perform the invocation by
+ *	itself, but has been suspended on an equivalent one instead.
+ */
+template <typename M_, typename Split_ = StateSplitShifted<M_> >
+class StateSplitShared: public Split_
+{
+public:
+	StateSplitShared (const State<M_>* a_caller, const State<M_>* a_shift,
+			const State<M_>* a_entry):
+		Split_ (a_caller, a_shift), m_entry (a_entry)
+	{
+	}
+
+public:
+	// Overridden from StateSplitShifted<M_>:
+
+	const State<M_>* get_entry () const
+	{
+		return m_entry;
+	}
+
+	std::size_t size () const
+	{
+		return sizeof(StateSplitShared<M_, Split_>);
+	}
+
+private:
+	const State<M_>* m_entry;
+
+};
+
 /******************************************************************************/
 
 } // namespace anta
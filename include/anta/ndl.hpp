@@ -44,6 +44,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 // [ contributed ]
 #include <util/callback.hpp>
+#include <util/small_map.hpp>
+#include <util/hash_trie.hpp>
 
 // [ local dependencies ]
 #include "core.hpp"
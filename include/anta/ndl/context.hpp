@@ -61,15 +61,12 @@ struct context_value
 template <typename M_>
 struct context_entry
 {
-// NOTE: Usage of *map<...>::value_type instead of pair<...> (see the commented
-//		 out lines below) prevents unnecessary copying of trace variables when
-//		 a trace context is being listed.
+// NOTE: Usage of the constant key type (which is what the trace variable
+//		 storage keeps) prevents unnecessary copying of trace variables when a
+//		 trace context is being listed.
 
-//	typedef std::pair<typename context_key<M_>::type,
-//			typename context_value<M_>::type> type;
-
-	typedef typename boost::unordered_map<typename context_key<M_>::type,
-			typename context_value<M_>::type>::value_type type;
+	typedef std::pair<const typename context_key<M_>::type,
+			typename context_value<M_>::type> type;
 
 };
 
@@ -221,8 +218,26 @@ public:
 	 */
 	Context (const Context* a_ancestor = NULL,
 			ContextOwner<M_>* a_owner = NULL):
-		m_ancestor (a_ancestor), m_owner (a_owner)
+		m_ancestor (a_ancestor), m_owner (a_owner),
+		m_root (a_ancestor ? a_ancestor -> root() : this), m_index (NULL),
+		m_depth (a_ancestor ? a_ancestor -> m_depth + 1 : 0),
+		m_generation (0), m_sealed (false), m_variables (a_owner)
+#if defined(ANTA_NDL_STACKING)
+		, m_marks (a_owner)
+#endif
+	{
+		if (a_ancestor != NULL)
+		{
+			a_ancestor -> m_sealed = true;
+		}
+	}
+
+	/**
+	 *	The destructor.
+	 */
+	~Context ()
 	{
+		delete m_index;
 	}
 
 	/**
@@ -251,6 +266,7 @@ public:
 							context<M_>::def()));
 			assert(p. second);
 			found_at = p. first;
+			update(*found_at);
 			if (! a_reset)
 			{
 				// NOTE: Trace variable assignment operator acts NOT the same
@@ -277,47 +293,55 @@ public:
 	template <typename Predicate_>
 	bool is_defined (const key_type& a_key, const Predicate_& a_predicate) const
 	{
-		for (const Context* c = this; c != NULL; c = c -> m_ancestor)
-		{
-			typename variables_t::const_iterator found_at =
-				c -> m_variables. find(a_key);
-			if (found_at != c -> m_variables. end())
-			{
-				return a_predicate(found_at -> second);
-			}
-		}
-		return false;
+		const entry_type* found = lookup(a_key, this);
+		return found != NULL && a_predicate(found -> second);
 	}
 
 private:
+	typedef typename context_entry<M_>::type entry_type;
+
 	/**
 	 *	Search for a certain variable within the global context starting form
 	 *	the given ancestor.
 	 */
 	const value_type& val (const key_type& a_key, const Context* c) const
+	{
+		const entry_type* found = lookup(a_key, c);
+		return found != NULL ? found -> second : context<M_>::def();
+	}
+
+	/**
+	 *	Find the visible entry of a certain variable within the global context
+	 *	starting from the given ancestor.
+	 */
+	static const entry_type* lookup (const key_type& a_key, const Context* c)
 	{
 		for ( ; c != NULL; c = c -> m_ancestor)
 		{
+			if (c -> is_checkpoint())
+			{
+				return c -> index(). find(a_key);
+			}
 			typename variables_t::const_iterator found_at =
 				c -> m_variables. find(a_key);
 			if (found_at != c -> m_variables. end())
 			{
-				return found_at -> second;
+				return &* found_at;
 			}
 		}
-		return context<M_>::def();
+		return NULL;
 	}
 
 private:
 	/**
-	 *	A helper predicate that filters out empty and repeated variables from
+	 *	A helper predicate that filters out empty and shadowed variables from
 	 *	the context.
 	 */
 	class list_filter
 	{
 	public:
-		list_filter (std::set<key_type>& a_passed):
-			m_passed (a_passed)
+		list_filter (const Context* a_context, uint_t& a_passed):
+			m_context (a_context), m_passed (a_passed)
 		{
 		}
 
@@ -328,17 +352,19 @@ private:
 			{
 				return true;
 			}
-			// Check if the key has been passed already.
-			if (! m_passed. insert(a_pair. first). second)
+			// Check if the key is redefined by a descendant.
+			if (lookup(a_pair. first, m_context) != &a_pair)
 			{
 				return true;
 			}
 			// If none of the conditions is met then approve copy.
+			++ m_passed;
 			return false;
 		}
 
 	private:
-		std::set<key_type>& m_passed;
+		const Context* m_context;
+		uint_t& m_passed;
 
 	};
 
@@ -363,13 +389,14 @@ public:
 		}
 		else
 		{
-			std::set<key_type> passed;
+			uint_t passed = 0;
 			for (const Context* c = this; c != NULL; c = c -> m_ancestor)
 			{
 				std::remove_copy_if(c -> m_variables. begin(),
-						c -> m_variables. end(), a_out, list_filter(passed));
+						c -> m_variables. end(), a_out,
+						list_filter(this, passed));
 			}
-			return static_cast<uint_t>(passed. size());
+			return passed;
 		}
 	}
 
@@ -392,18 +419,182 @@ public:
 	}
 
 private:
+	// NOTE: Every index_interval-th context of a chain keeps an index of all
+	//		 the trace variables visible from it, which shares nodes with the
+	//		 index of the previous such context, so that a lookup checks a few
+	//		 contexts at most. An index is built on demand, and gets rebuilt
+	//		 whenever a context that has descendants within the same tree is
+	//		 extended with a new variable (which bumps the generation number
+	//		 kept by the root of the tree).
+	static const uint_t index_interval = 8;
+
+	typedef utility::hash_trie<entry_type> trie_t;
+
+	/**
+	 *	The index of trace variables.
+	 */
+	struct index_t
+	{
+		trie_t trie; /**< visible entries */
+		const Context* root; /**< root of the tree at the moment of building */
+		uint_t generation; /**< generation of the tree */
+
+	};
+
 	const Context* m_ancestor; /**< ancestor context */
 	ContextOwner<M_>* m_owner; /**< context's owner */
-
-	typedef boost::unordered_map<key_type, value_type> variables_t;
+	mutable const Context* m_root; /**< (a link towards) the tree root */
+	mutable index_t* m_index; /**< trace variable index */
+	unsigned int m_depth; /**< number of ancestors */
+	mutable unsigned int m_generation; /**< generation number of a root */
+	mutable bool m_sealed; /**< whether the context has descendants */
+
+	// NOTE: Most contexts hold a few variables only, so that they are kept in
+	//		 a flat map, which draws its storage from the pool of the context
+	//		 owner.
+	typedef utility::small_map<key_type, value_type, ContextOwner<M_> >
+		variables_t;
 	variables_t m_variables; /**< local trace variable map */
 
+	/**
+	 *	Get the root of the tree the context belongs to.
+	 */
+	const Context* root () const
+	{
+		while (m_root -> m_root != m_root)
+		{
+			m_root = m_root -> m_root;
+		}
+		return m_root;
+	}
+
+	/**
+	 *	Check whether the context keeps an index of trace variables.
+	 */
+	bool is_checkpoint () const
+	{
+		return m_depth != 0 && m_depth % index_interval == 0;
+	}
+
+	/**
+	 *	Find the nearest ancestor that keeps an index of trace variables.
+	 */
+	const Context* checkpoint () const
+	{
+		const Context* c = m_ancestor;
+		while (c != NULL && ! c -> is_checkpoint())
+		{
+			c = c -> m_ancestor;
+		}
+		return c;
+	}
+
+	/**
+	 *	Check whether the index of trace variables is up to date.
+	 */
+	bool has_index () const
+	{
+		return m_index != NULL && m_index -> root == root()
+			&& m_index -> generation == root() -> m_generation;
+	}
+
+	/**
+	 *	Get the up to date index of trace variables.
+	 */
+	const trie_t& index () const
+	{
+		if (! has_index())
+		{
+			// NOTE: The outdated indices of the preceding checkpoints are
+			//		 rebuilt first, since each of them serves as the base for
+			//		 the next one.
+			std::vector<const Context*> outdated;
+			for (const Context* c = this; c != NULL && ! c -> has_index();
+					c = c -> checkpoint())
+			{
+				outdated. push_back(c);
+			}
+			for (typename std::vector<const Context*>::reverse_iterator
+					i = outdated. rbegin(); i != outdated. rend(); ++ i)
+			{
+				(*i) -> build();
+			}
+		}
+		return m_index -> trie;
+	}
+
+	/**
+	 *	Build the index of trace variables on top of the one of the nearest
+	 *	checkpoint.
+	 */
+	void build () const
+	{
+		if (m_index == NULL)
+		{
+			m_index = new index_t();
+		}
+
+		const Context* base = checkpoint();
+		if (base != NULL)
+		{
+			m_index -> trie. assign(base -> m_index -> trie);
+		}
+		else
+		{
+			m_index -> trie. clear();
+		}
+
+		// Index the contexts in between, the outer ones first, so that the
+		// inner ones redefine their variables.
+		std::vector<const Context*> chain;
+		for (const Context* c = this; c != base; c = c -> m_ancestor)
+		{
+			chain. push_back(c);
+		}
+		for (typename std::vector<const Context*>::reverse_iterator
+				i = chain. rbegin(); i != chain. rend(); ++ i)
+		{
+			for (typename variables_t::const_iterator
+					j = (*i) -> m_variables. begin();
+					j != (*i) -> m_variables. end(); ++ j)
+			{
+				m_index -> trie. insert(&* j);
+			}
+		}
+
+		m_index -> root = root();
+		m_index -> generation = root() -> m_generation;
+	}
+
+	/**
+	 *	Account a newly defined local trace variable.
+	 */
+	void update (const entry_type& a_entry)
+	{
+		if (m_sealed)
+		{
+			// NOTE: This outdates the indices of the descendants as well as
+			//		 the ones of the preceding checkpoints, which the index of
+			//		 the context shares nodes with, so that it is rebuilt on
+			//		 demand too.
+			++ root() -> m_generation;
+		}
+		else if (has_index())
+		{
+			m_index -> trie. insert(&a_entry);
+		}
+	}
+
+	// NOTE: Contexts are referred to by their descendants, and never copied.
+	Context (const Context&);
+	Context& operator= (const Context&);
+
 #if defined(ANTA_NDL_STACKING)
 private:
 	static const uint_t FLAG_PUSH = 1;
 	static const uint_t FLAG_POP = 2;
 
-	typedef boost::unordered_map<key_type, int> marks_t;
+	typedef utility::small_map<key_type, int, ContextOwner<M_> > marks_t;
 	marks_t m_marks; /**< marked trace variables */
 
 	/**
@@ -502,10 +693,19 @@ public:
 	/**
 	 *	Set the ancestor context.
 	 *	NOTE:	Extremely unsafe when is not used property. Handle with care!
+	 *			The context is supposed to be the root of its tree.
 	 */
 	void set_ancestor (const Context* a_ancestor)
 	{
+		// Outdate the indices of the descendants.
+		++ root() -> m_generation;
+		if (a_ancestor != NULL)
+		{
+			a_ancestor -> m_sealed = true;
+		}
 		m_ancestor = a_ancestor;
+		m_root = a_ancestor ? a_ancestor -> root() : this;
+		m_depth = a_ancestor ? a_ancestor -> m_depth + 1 : 0;
 	}
 #endif // ANTA_NDL_MUTABLE_ANCESTOR
 
@@ -518,6 +718,14 @@ template <typename M_>
 class ContextOwner: public pool<M_>::type
 {
 public:
+	/**
+	 *	The destructor.
+	 */
+	~ContextOwner ()
+	{
+		reset();
+	}
+
 	/**
 	 *	Create an instance of the Context class.
 	 */
@@ -98,6 +98,15 @@ public:
 		return true;
 	}
 
+	/**
+	 *	Get a digest of the environment an invocation entry state has been
+	 *	entered in, which is the trace context in effect for the state.
+	 */
+	const void* memo_digest (const State<M_>* a_state) const
+	{
+		return a_state -> context(NULL);
+	}
+
 	/**
 	 *	Reset the processor.
 	 */
@@ -419,6 +428,31 @@ struct rollback_performer<Processor<typename ndl::extend<M_>::type>, M_>
 
 };
 
+/**
+ *	A specialization of the defunct state disposal mechanism for extended
+ *	models.
+ */
+template <typename M_>
+struct disposal_performer<Processor<typename ndl::extend<M_>::type>, M_>
+{
+	static void f (Processor<M_>& a_proc, const State<M_>* a_state)
+	{
+		a_proc. get_observer(). notify(evEVICT, a_state);
+		if (a_state -> is_own_context())
+		{
+			// NOTE: A reclaimed segment gets overwritten, therefore the context
+			//		 has to be destroyed first.
+			ndl::Context<M_>* ctx = a_state -> get_context();
+			if (a_proc. destroy(ctx))
+			{
+				a_proc. reclaim(ctx, sizeof(*ctx));
+			}
+		}
+		a_proc. reclaim(a_state, a_state -> size());
+	}
+
+};
+
 /******************************************************************************/
 
 } // namespace anta
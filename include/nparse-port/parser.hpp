@@ -90,6 +90,8 @@ public:
 	 *	Functions used to operate parser and navigate found traces.
 	 *	@{ */
 	bool parse (const wchar_t* a_input, const int a_len = 0);
+	bool reparse (const int a_edit_begin, const int a_edit_end,
+			const wchar_t* a_text, const int a_len = 0);
 	bool next ();
 	bool step ();
 	void rewind ();
@@ -124,6 +124,26 @@ struct pool<nparse::NLG>
 				: m_file. evict(a_ptr, a_size);
 		}
 
+		/**
+		 *	Reclaim a dead segment wherever it is.
+		 */
+		bool reclaim (const void* a_ptr, const std::size_t a_size)
+		{
+			return m_use_ramd
+				? m_ramd. reclaim(a_ptr, a_size)
+				: m_file. reclaim(a_ptr, a_size);
+		}
+
+		/**
+		 *	Set the lowest address that reclaimed segments may be reused above.
+		 */
+		void set_floor (const void* a_floor)
+		{
+			return m_use_ramd
+				? m_ramd. set_floor(a_floor)
+				: m_file. set_floor(a_floor);
+		}
+
 		/**
 		 *	Clear the pool.
 		 */
@@ -38,27 +38,30 @@ public:
 	typedef std::size_t result_type;
 
 	hashed_string ():
-		m_hash (0)
+		m_record (NULL)
 	{
 	}
 
 	template <typename First_>
 	hashed_string (const First_& a_first):
-		m_hash (0)
+		m_record (NULL)
 	{
 		init(encode::string(a_first));
 	}
 
 	result_type hash () const
 	{
-		return m_hash;
+		return (m_record != NULL) ? m_record -> hash : 0;
 	}
 
-	operator const std::string& () const;
+	operator const std::string& () const
+	{
+		return (m_record != NULL) ? m_record -> text : empty_text();
+	}
 
 	bool empty () const
 	{
-		return (m_hash == 0);
+		return (m_record == NULL);
 	}
 
 	typedef std::string::const_iterator const_iterator;
@@ -75,14 +78,36 @@ public:
 
 	void swap (hashed_string& a_hs)
 	{
-		std::swap(m_hash, a_hs. m_hash);
+		std::swap(m_record, a_hs. m_record);
+	}
+
+	friend bool operator== (const hashed_string& u, const hashed_string& v)
+	{
+		return (u. m_record == v. m_record);
 	}
 
 private:
-	result_type m_hash;
+	/**
+	 *	An interned string. Records are never modified after publication nor
+	 *	deleted, so that a hashed string refers to its text directly.
+	 */
+	struct record
+	{
+		result_type hash; /**< unique hash of the string */
+		std::string text; /**< text of the string */
+		const record* next; /**< next record within the same bucket */
+
+	};
+
+	class table;
+	friend class table;
+
+	const record* m_record;
 
 	void init (const std::string& a_str);
 
+	static const std::string& empty_text ();
+
 };
 
 inline bool operator< (const hashed_string& u, const hashed_string& v)
@@ -105,14 +130,9 @@ inline bool operator>= (const hashed_string& u, const hashed_string& v)
 	return u. hash() >= v. hash();
 }
 
-inline bool operator== (const hashed_string& u, const hashed_string& v)
-{
-	return u. hash() == v. hash();
-}
-
 inline bool operator!= (const hashed_string& u, const hashed_string& v)
 {
-	return u. hash() != v. hash();
+	return ! (u == v);
 }
 
 inline std::ostream& operator<< (std::ostream& a_out, const hashed_string& a_hs)
@@ -35,11 +35,12 @@ template <typename M_>
 const anta::State<M_>* offset_state (const anta::State<M_>* s,
 		const int a_offset = 0)
 {
+	anta::ancestry<M_> a(s);
 	for (int offset = a_offset + 1; offset; -- offset)
 	{
 		do
 		{
-			s = s -> get_ancestor();
+			s = a. next();
 			if (!s)
 				return NULL;
 		} while (! s -> get_arc(). get_label(). is_actual());
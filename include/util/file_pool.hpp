@@ -29,6 +29,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include <stdexcept>
 #include <boost/iostreams/device/mapped_file.hpp>
+#include "free_list.hpp"
 
 namespace utility {
 
@@ -114,11 +115,11 @@ public:
 	}
 
 	/**
-	 *	Get current pool usage.
+	 *	Get current pool usage (reclaimed segments are not counted).
 	 */
 	std::size_t get_usage () const
 	{
-		return m_used;
+		return m_used - m_free. size();
 	}
 
 	/**
@@ -142,11 +143,19 @@ public:
 	 */
 	void* allocate (const std::size_t a_size)
 	{
+		if (void* ptr = m_free. take(a_size))
+		{
+			track_peak(get_usage());
+			return ptr;
+		}
 		if (m_used + a_size > get_capacity())
 		{
 			throw std::bad_alloc();
 		}
-		return m_file. data() + (track_peak(m_used += a_size) - a_size);
+		m_used += a_size;
+		track_peak(get_usage());
+		m_free. set_floor(m_file. data() + m_used - a_size);
+		return m_file. data() + m_used - a_size;
 	}
 
 	/**
@@ -157,18 +166,52 @@ public:
 		const char* probe = reinterpret_cast<const char*>(a_ptr);
 		if (m_file. data() + m_used - a_size == probe)
 		{
-			m_used -= a_size;
+			m_used = m_free. retract(m_file. data() + m_used - a_size)
+				- m_file. data();
 			m_evicted += a_size;
 			return true;
 		}
 		return false;
 	}
 
+	/**
+	 *	Reclaim a dead segment wherever it is. The last allocated segment gets
+	 *	evicted, whereas any other segment gets reused by later allocations of
+	 *	the same size.
+	 *
+	 *	@return
+	 *		Whether the segment has been reclaimed
+	 */
+	bool reclaim (const void* a_ptr, const std::size_t a_size)
+	{
+		if (evict(a_ptr, a_size))
+		{
+			return true;
+		}
+		if (! free_list::fits(a_size))
+		{
+			return false;
+		}
+		m_free. put(const_cast<void*>(a_ptr), a_size);
+		m_evicted += a_size;
+		return true;
+	}
+
+	/**
+	 *	Set the lowest address that reclaimed segments may be reused above. The
+	 *	floor rises with every allocation until it is set again.
+	 */
+	void set_floor (const void* a_floor)
+	{
+		m_free. set_floor(a_floor);
+	}
+
 	/**
 	 *	Clear the pool.
 	 */
 	void clear ()
 	{
+		m_free. clear();
 		m_used = 0;
 		m_peak = 0;
 		m_evicted = 0;
@@ -180,11 +223,11 @@ private:
 	std::size_t m_used;
 	std::size_t m_peak;
 	std::size_t m_evicted;
+	free_list m_free;
 
-	std::size_t track_peak (const std::size_t a_size)
+	void track_peak (const std::size_t a_size)
 	{
 		m_peak = std::max(m_peak, a_size);
-		return a_size;
 	}
 
 };
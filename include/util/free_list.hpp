@@ -0,0 +1,205 @@
+/*
+ * @file $/include/util/free_list.hpp
+ *
+This file is a part of the "nParse" project -
+        a general purpose parsing framework, version 0.1.8
+
+The MIT License (MIT)
+Copyright (c) 2007-2017 Alex Kudinov <alex.s.kudinov@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef UTIL_FREE_LIST_HPP_
+#define UTIL_FREE_LIST_HPP_
+
+#include <map>
+#include <algorithm>
+
+namespace utility {
+
+/**
+ *	Index of dead segments reclaimed from the middle of a byte pool.
+ *
+ *	Reclaimed segments are arranged in size classes, so that they could be
+ *	reused by later allocations of the same size. Since pool users may rely on
+ *	the order of addresses, a segment is only reused if it lies above the given
+ *	lower bound (the floor), which is raised past every segment taken, so that
+ *	consecutive allocations keep growing in address.
+ */
+class free_list
+{
+public:
+	/**
+	 *	Size class granularity and the number of size classes.
+	 */
+	static const std::size_t granularity = sizeof(void*);
+	static const std::size_t class_count = 64;
+
+public:
+	/**
+	 *	The only constructor.
+	 */
+	free_list ():
+		m_floor (NULL), m_size (0)
+	{
+		std::fill(m_heads, m_heads + class_count, static_cast<link*>(NULL));
+	}
+
+	/**
+	 *	Check whether a segment of the given size can be reclaimed.
+	 */
+	static bool fits (const std::size_t a_size)
+	{
+		return a_size >= sizeof(link)
+			&& a_size % granularity == 0
+			&& a_size / granularity < class_count;
+	}
+
+	/**
+	 *	Get total size of the reclaimed segments.
+	 */
+	std::size_t size () const
+	{
+		return m_size;
+	}
+
+	/**
+	 *	Set the lowest address that reclaimed segments may be reused above.
+	 */
+	void set_floor (const void* a_floor)
+	{
+		m_floor = static_cast<const char*>(a_floor);
+	}
+
+	/**
+	 *	Add a dead segment to the index.
+	 */
+	void put (void* a_ptr, const std::size_t a_size)
+	{
+		link* l = static_cast<link*>(a_ptr);
+		link*& head = m_heads[a_size / granularity];
+		l -> prev = NULL;
+		l -> next = head;
+		if (head != NULL)
+		{
+			head -> prev = l;
+		}
+		head = l;
+		m_index[static_cast<const char*>(a_ptr)] = a_size;
+		m_size += a_size;
+	}
+
+	/**
+	 *	Take the most recently reclaimed segment of the given size, if it lies
+	 *	above the floor, and raise the floor to it.
+	 *
+	 *	@return
+	 *		Segment pointer, or NULL if there is no suitable segment
+	 */
+	void* take (const std::size_t a_size)
+	{
+		if (m_size == 0 || ! fits(a_size))
+		{
+			return NULL;
+		}
+		link* l = m_heads[a_size / granularity];
+		if (l == NULL || reinterpret_cast<const char*>(l) <= m_floor)
+		{
+			return NULL;
+		}
+		remove(l, a_size);
+		m_index. erase(reinterpret_cast<const char*>(l));
+		m_floor = reinterpret_cast<const char*>(l);
+		return l;
+	}
+
+	/**
+	 *	Withdraw the reclaimed segments that immediately precede the given end
+	 *	of the used pool space.
+	 *
+	 *	@return
+	 *		New end of the used pool space
+	 */
+	char* retract (char* a_end)
+	{
+		while (! m_index. empty())
+		{
+			index_type::iterator i = m_index. end();
+			-- i;
+			if (i -> first + i -> second != a_end)
+			{
+				break;
+			}
+			a_end -= i -> second;
+			remove(reinterpret_cast<link*>(a_end), i -> second);
+			m_index. erase(i);
+		}
+		return a_end;
+	}
+
+	/**
+	 *	Clear the index.
+	 */
+	void clear ()
+	{
+		std::fill(m_heads, m_heads + class_count, static_cast<link*>(NULL));
+		m_index. clear();
+		m_floor = NULL;
+		m_size = 0;
+	}
+
+private:
+	/**
+	 *	Size class list node stored in place of a reclaimed segment.
+	 */
+	struct link
+	{
+		link* prev;
+		link* next;
+
+	};
+
+	typedef std::map<const char*, std::size_t> index_type;
+
+	link* m_heads[class_count];		/**< size class lists */
+	index_type m_index;				/**< reclaimed segments by address */
+	const char* m_floor;			/**< lowest reusable address */
+	std::size_t m_size;				/**< total reclaimed size */
+
+	void remove (link* a_link, const std::size_t a_size)
+	{
+		if (a_link -> prev != NULL)
+		{
+			a_link -> prev -> next = a_link -> next;
+		}
+		else
+		{
+			m_heads[a_size / granularity] = a_link -> next;
+		}
+		if (a_link -> next != NULL)
+		{
+			a_link -> next -> prev = a_link -> prev;
+		}
+		m_size -= a_size;
+	}
+
+};
+
+} // namespace utility
+
+#endif /* UTIL_FREE_LIST_HPP_ */
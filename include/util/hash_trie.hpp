@@ -0,0 +1,393 @@
+/*
+ * @file $/include/util/hash_trie.hpp
+ *
+This file is a part of the "nParse" project -
+        a general purpose parsing framework, version 0.1.8
+
+The MIT License (MIT)
+Copyright (c) 2007-2017 Alex Kudinov <alex.s.kudinov@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef UTIL_HASH_TRIE_HPP_
+#define UTIL_HASH_TRIE_HPP_
+
+#include <new>
+#include <cstddef>
+#include <boost/functional/hash.hpp>
+#include <boost/type_traits/remove_const.hpp>
+
+namespace utility {
+
+/**
+ *	Persistent hash array mapped trie that indexes entries by their keys.
+ *
+ *	The trie keeps pointers to the entries (anything having the key in the
+ *	"first" member) that reside elsewhere. A trie may be initialized with
+ *	another trie, in which case the both share the nodes, and an insertion
+ *	copies the nodes along the path of the key only, so that the original trie
+ *	stays intact. The nodes a trie has created are owned by it, and get
+ *	updated in place when possible.
+ *
+ *	NOTE: A trie that shares nodes of another one must be destroyed (or
+ *		  reassigned) before the latter gets modified or destroyed.
+ */
+template <typename Entry_, typename Hash_ = boost::hash<
+	typename boost::remove_const<typename Entry_::first_type>::type> >
+class hash_trie
+{
+public:
+	typedef typename boost::remove_const<
+		typename Entry_::first_type>::type key_type;
+	typedef Entry_ entry_type;
+
+public:
+	/**
+	 *	The default constructor.
+	 */
+	hash_trie ():
+		m_root (NULL), m_size (0), m_own_root (false)
+	{
+	}
+
+	/**
+	 *	The destructor.
+	 */
+	~hash_trie ()
+	{
+		clear();
+	}
+
+	/**
+	 *	Share the contents of the given trie.
+	 */
+	void assign (const hash_trie& a_base)
+	{
+		if (this != &a_base)
+		{
+			clear();
+			m_root = a_base. m_root;
+			m_size = a_base. m_size;
+		}
+	}
+
+	/**
+	 *	Forget all the entries, and release the owned nodes.
+	 */
+	void clear ()
+	{
+		if (m_own_root)
+		{
+			release(m_root);
+		}
+		m_root = NULL;
+		m_size = 0;
+		m_own_root = false;
+	}
+
+	/**
+	 *	Get the number of the indexed entries.
+	 */
+	std::size_t size () const
+	{
+		return m_size;
+	}
+
+	/**
+	 *	Find the entry of the given key.
+	 *
+	 *	@return
+	 *		Pointer to the entry, or NULL if there is no such key
+	 */
+	const entry_type* find (const key_type& a_key) const
+	{
+		const std::size_t hash = Hash_()(a_key);
+		const node* n = m_root;
+		for (std::size_t shift = 0; n != NULL; shift += bits_per_level)
+		{
+			if (shift >= hash_bits)
+			{
+				return scan(n, a_key);
+			}
+			const bitmap_type bit = 1U << ((hash >> shift) & level_mask);
+			if ((n -> bitmap & bit) == 0)
+			{
+				return NULL;
+			}
+			const slot_type s = n -> slots[position(n -> bitmap, bit)];
+			if (is_entry(s))
+			{
+				const entry_type* e = to_entry(s);
+				return e -> first == a_key ? e : NULL;
+			}
+			n = to_node(s);
+		}
+		return NULL;
+	}
+
+	/**
+	 *	Index the given entry, replacing the one of the same key, if any.
+	 */
+	void insert (const entry_type* a_entry)
+	{
+		if (m_root == NULL)
+		{
+			m_root = create(0, 1);
+			m_root -> bitmap = 1U << (hash_of(a_entry) & level_mask);
+			m_root -> slots[0] = from_entry(a_entry);
+			m_own_root = true;
+			++ m_size;
+			return;
+		}
+		m_root = insert(m_root, m_own_root, a_entry, hash_of(a_entry), 0);
+		m_own_root = true;
+	}
+
+private:
+	typedef unsigned int bitmap_type;
+	typedef std::size_t slot_type;
+
+	static const std::size_t bits_per_level = 5;
+	static const std::size_t level_mask = (1U << bits_per_level) - 1;
+	static const std::size_t hash_bits = sizeof(std::size_t) * 8;
+
+	// NOTE: A slot either points to an entry (the lowest bit is set) or to
+	//		 a child node (the second bit is set if the node is owned).
+	static const slot_type ENTRY = 1;
+	static const slot_type OWNED = 2;
+
+	/**
+	 *	A trie node. A node beyond the hash bits holds colliding entries, and
+	 *	does not use the bitmap.
+	 */
+	struct node
+	{
+		bitmap_type bitmap;
+		bitmap_type count;
+		slot_type slots[1];
+
+	};
+
+	node* m_root; /**< root node */
+	std::size_t m_size; /**< number of entries */
+	bool m_own_root; /**< whether the root node is owned */
+
+	static std::size_t hash_of (const entry_type* a_entry)
+	{
+		return Hash_()(a_entry -> first);
+	}
+
+	static bool is_entry (const slot_type a_slot)
+	{
+		return (a_slot & ENTRY) != 0;
+	}
+
+	static const entry_type* to_entry (const slot_type a_slot)
+	{
+		return reinterpret_cast<const entry_type*>(a_slot & ~ENTRY);
+	}
+
+	static slot_type from_entry (const entry_type* a_entry)
+	{
+		return reinterpret_cast<slot_type>(a_entry) | ENTRY;
+	}
+
+	static node* to_node (const slot_type a_slot)
+	{
+		return reinterpret_cast<node*>(a_slot & ~OWNED);
+	}
+
+	static slot_type from_node (const node* a_node, const bool a_owned)
+	{
+		return reinterpret_cast<slot_type>(a_node) | (a_owned ? OWNED : 0);
+	}
+
+	static std::size_t position (const bitmap_type a_bitmap, const bitmap_type a_bit)
+	{
+		bitmap_type v = a_bitmap & (a_bit - 1);
+		v = v - ((v >> 1) & 0x55555555);
+		v = (v & 0x33333333) + ((v >> 2) & 0x33333333);
+		return (((v + (v >> 4)) & 0x0F0F0F0F) * 0x01010101) >> 24;
+	}
+
+	static node* create (const bitmap_type a_bitmap, const bitmap_type a_count)
+	{
+		node* n = static_cast<node*>(::operator new(sizeof(node)
+					+ (a_count - 1) * sizeof(slot_type)));
+		n -> bitmap = a_bitmap;
+		n -> count = a_count;
+		return n;
+	}
+
+	/**
+	 *	Copy a node (the copy does not own any of the children).
+	 */
+	static node* copy (const node* a_node)
+	{
+		node* n = create(a_node -> bitmap, a_node -> count);
+		for (bitmap_type i = 0; i < n -> count; ++ i)
+		{
+			n -> slots[i] = a_node -> slots[i] & ~(is_entry(a_node -> slots[i])
+					? 0 : OWNED);
+		}
+		return n;
+	}
+
+	static void release (node* a_node)
+	{
+		for (bitmap_type i = 0; i < a_node -> count; ++ i)
+		{
+			const slot_type s = a_node -> slots[i];
+			if (! is_entry(s) && (s & OWNED) != 0)
+			{
+				release(to_node(s));
+			}
+		}
+		::operator delete(a_node);
+	}
+
+	static const entry_type* scan (const node* a_node, const key_type& a_key)
+	{
+		for (bitmap_type i = 0; i < a_node -> count; ++ i)
+		{
+			const entry_type* e = to_entry(a_node -> slots[i]);
+			if (e -> first == a_key)
+			{
+				return e;
+			}
+		}
+		return NULL;
+	}
+
+	/**
+	 *	Make a node that holds the two given entries of different keys.
+	 */
+	static node* join (const entry_type* a_first, const std::size_t a_first_hash,
+			const entry_type* a_second, const std::size_t a_second_hash,
+			const std::size_t a_shift)
+	{
+		if (a_shift >= hash_bits)
+		{
+			node* n = create(0, 2);
+			n -> slots[0] = from_entry(a_first);
+			n -> slots[1] = from_entry(a_second);
+			return n;
+		}
+		const std::size_t i = (a_first_hash >> a_shift) & level_mask;
+		const std::size_t j = (a_second_hash >> a_shift) & level_mask;
+		if (i == j)
+		{
+			node* n = create(1U << i, 1);
+			n -> slots[0] = from_node(join(a_first, a_first_hash,
+						a_second, a_second_hash, a_shift + bits_per_level),
+					true);
+			return n;
+		}
+		node* n = create((1U << i) | (1U << j), 2);
+		n -> slots[i < j ? 0 : 1] = from_entry(a_first);
+		n -> slots[i < j ? 1 : 0] = from_entry(a_second);
+		return n;
+	}
+
+	/**
+	 *	Make a node that has an extra slot at the given position.
+	 */
+	static node* widen (node* a_node, const bool a_owned,
+			const bitmap_type a_bit, const std::size_t a_pos,
+			const slot_type a_slot)
+	{
+		node* n = create(a_node -> bitmap | a_bit, a_node -> count + 1);
+		for (std::size_t i = 0, j = 0; i < n -> count; ++ i)
+		{
+			n -> slots[i] = (i == a_pos) ? a_slot : a_node -> slots[j ++];
+			if (! a_owned && i != a_pos && ! is_entry(n -> slots[i]))
+			{
+				n -> slots[i] &= ~OWNED;
+			}
+		}
+		if (a_owned)
+		{
+			::operator delete(a_node);
+		}
+		return n;
+	}
+
+	node* insert (node* a_node, const bool a_owned, const entry_type* a_entry,
+			const std::size_t a_hash, const std::size_t a_shift)
+	{
+		if (a_shift >= hash_bits)
+		{
+			for (bitmap_type i = 0; i < a_node -> count; ++ i)
+			{
+				if (to_entry(a_node -> slots[i]) -> first == a_entry -> first)
+				{
+					node* n = a_owned ? a_node : copy(a_node);
+					n -> slots[i] = from_entry(a_entry);
+					return n;
+				}
+			}
+			++ m_size;
+			return widen(a_node, a_owned, 0, a_node -> count,
+					from_entry(a_entry));
+		}
+
+		const bitmap_type bit = 1U << ((a_hash >> a_shift) & level_mask);
+		const std::size_t pos = position(a_node -> bitmap, bit);
+		if ((a_node -> bitmap & bit) == 0)
+		{
+			++ m_size;
+			return widen(a_node, a_owned, bit, pos, from_entry(a_entry));
+		}
+
+		const slot_type s = a_node -> slots[pos];
+		slot_type replacement;
+		if (is_entry(s))
+		{
+			const entry_type* e = to_entry(s);
+			if (e -> first == a_entry -> first)
+			{
+				replacement = from_entry(a_entry);
+			}
+			else
+			{
+				++ m_size;
+				replacement = from_node(join(e, hash_of(e), a_entry, a_hash,
+							a_shift + bits_per_level), true);
+			}
+		}
+		else
+		{
+			// NOTE: The owned flags of a shared node are those of its owner.
+			replacement = from_node(insert(to_node(s),
+						a_owned && (s & OWNED) != 0, a_entry, a_hash,
+						a_shift + bits_per_level), true);
+		}
+		node* n = a_owned ? a_node : copy(a_node);
+		n -> slots[pos] = replacement;
+		return n;
+	}
+
+	// NOTE: The nodes are shared, so that tries are not copyable.
+	hash_trie (const hash_trie&);
+	hash_trie& operator= (const hash_trie&);
+
+};
+
+} // namespace utility
+
+#endif /* UTIL_HASH_TRIE_HPP_ */
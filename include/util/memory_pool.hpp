@@ -28,20 +28,46 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #define UTIL_MEMORY_POOL_HPP_
 
 #include <stdexcept>
+#include <algorithm>
+#if defined(_WIN32)
+#if !defined(NOMINMAX)
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+#include "free_list.hpp"
 
 namespace utility {
 
 /**
- *	Preallocated memory byte pool.
+ *	Growable memory byte pool.
+ *
+ *	The pool reserves a contiguous range of address space of the requested
+ *	capacity up front, but commits physical memory in segments as the pool
+ *	grows. Allocated segments never move, the addresses grow monotonically
+ *	(so that objects allocated earlier always reside at lower addresses) and
+ *	the committed memory is returned to the system when the pool is cleared.
+ *
+ *	Dead segments that can not be evicted from the tail are reclaimed to
+ *	size class free lists for reuse.
  */
 class memory_pool
 {
+public:
+	/**
+	 *	Size of a segment of physical memory committed at once.
+	 */
+	static const std::size_t segment_size = 256 << 10;
+
 public:
 	/**
 	 *	The only constructor.
 	 */
 	memory_pool ():
-		m_bytes (NULL), m_capacity (0), m_used (0), m_peak (0), m_evicted (0)
+		m_bytes (NULL), m_capacity (0), m_reserved (0), m_committed (0),
+		m_used (0), m_peak (0), m_evicted (0)
 	{
 	}
 
@@ -50,12 +76,7 @@ public:
 	 */
 	~memory_pool ()
 	{
-		if (m_bytes != NULL)
-		{
-			delete[] m_bytes;
-			m_bytes = NULL;
-		}
-		m_capacity = 0;
+		release();
 		m_used = 0;
 		m_peak = 0;
 		m_evicted = 0;
@@ -71,6 +92,10 @@ public:
 
 	/**
 	 *	Set total pool capacity.
+	 *
+	 *	NOTE: Only the address space is reserved here, so the capacity may be
+	 *		  set generously: physical memory usage is determined by the actual
+	 *		  peak pool usage.
 	 */
 	void set_capacity (const std::size_t a_size)
 	{
@@ -79,23 +104,27 @@ public:
 			throw std::logic_error("unable to change the capacity of a pool"
 					" that is already in use");
 		}
-		if (m_bytes != NULL)
-		{
-			delete[] m_bytes;
-			m_bytes = NULL;
-		}
-		if ((m_capacity = a_size) > 0)
+		release();
+		if (a_size > 0)
 		{
-			m_bytes = new char[m_capacity];
+			reserve(a_size);
 		}
 	}
 
 	/**
-	 *	Get current pool usage.
+	 *	Get size of the physical memory currently committed by the pool.
+	 */
+	std::size_t get_committed_size () const
+	{
+		return m_committed;
+	}
+
+	/**
+	 *	Get current pool usage (reclaimed segments are not counted).
 	 */
 	std::size_t get_usage () const
 	{
-		return m_used;
+		return m_used - m_free. size();
 	}
 
 	/**
@@ -119,33 +148,83 @@ public:
 	 */
 	void* allocate (const std::size_t a_size)
 	{
-		if (m_used + a_size > m_capacity)
+		if (void* ptr = m_free. take(a_size))
 		{
-			throw std::bad_alloc();
+			track_peak(get_usage());
+			return ptr;
+		}
+		if (m_used + a_size > m_committed)
+		{
+			if (m_used + a_size > m_capacity)
+			{
+				throw std::bad_alloc();
+			}
+			commit(m_used + a_size);
 		}
-		return m_bytes + (track_peak(m_used += a_size) - a_size);
+		m_used += a_size;
+		track_peak(get_usage());
+		m_free. set_floor(m_bytes + m_used - a_size);
+		return m_bytes + m_used - a_size;
 	}
 
 	/**
 	 *	Try to evict the last allocated segment.
+	 *
+	 *	NOTE: The committed memory is kept until the pool is cleared, so that
+	 *		  the pool usage oscillating around a segment boundary does not
+	 *		  cause excessive system calls.
 	 */
 	bool evict (const void* a_ptr, const std::size_t a_size)
 	{
 		const char* probe = reinterpret_cast<const char*>(a_ptr);
 		if (m_bytes + m_used - a_size == probe)
 		{
-			m_used -= a_size;
+			m_used = m_free. retract(m_bytes + m_used - a_size) - m_bytes;
 			m_evicted += a_size;
 			return true;
 		}
 		return false;
 	}
 
+	/**
+	 *	Reclaim a dead segment wherever it is. The last allocated segment gets
+	 *	evicted, whereas any other segment gets reused by later allocations of
+	 *	the same size.
+	 *
+	 *	@return
+	 *		Whether the segment has been reclaimed
+	 */
+	bool reclaim (const void* a_ptr, const std::size_t a_size)
+	{
+		if (evict(a_ptr, a_size))
+		{
+			return true;
+		}
+		if (! free_list::fits(a_size))
+		{
+			return false;
+		}
+		m_free. put(const_cast<void*>(a_ptr), a_size);
+		m_evicted += a_size;
+		return true;
+	}
+
+	/**
+	 *	Set the lowest address that reclaimed segments may be reused above. The
+	 *	floor rises with every allocation until it is set again.
+	 */
+	void set_floor (const void* a_floor)
+	{
+		m_free. set_floor(a_floor);
+	}
+
 	/**
 	 *	Clear the pool.
 	 */
 	void clear ()
 	{
+		decommit(segment_size);
+		m_free. clear();
 		m_used = 0;
 		m_peak = 0;
 		m_evicted = 0;
@@ -154,14 +233,104 @@ public:
 private:
 	char* m_bytes;
 	std::size_t m_capacity;
+	std::size_t m_reserved;
+	std::size_t m_committed;
 	std::size_t m_used;
 	std::size_t m_peak;
 	std::size_t m_evicted;
+	free_list m_free;
 
-	std::size_t track_peak (const std::size_t a_size)
+	void track_peak (const std::size_t a_size)
 	{
 		m_peak = std::max(m_peak, a_size);
-		return a_size;
+	}
+
+	/**
+	 *	Reserve address space for the given capacity (nothing is committed).
+	 */
+	void reserve (const std::size_t a_size)
+	{
+		const std::size_t size =
+			(a_size + segment_size - 1) / segment_size * segment_size;
+#if defined(_WIN32)
+		void* ptr = VirtualAlloc(NULL, size, MEM_RESERVE, PAGE_NOACCESS);
+		if (ptr == NULL)
+		{
+			throw std::bad_alloc();
+		}
+#else
+		void* ptr = mmap(NULL, size, PROT_NONE,
+				MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+		if (ptr == MAP_FAILED)
+		{
+			throw std::bad_alloc();
+		}
+#endif
+		m_bytes = static_cast<char*>(ptr);
+		m_capacity = a_size;
+		m_reserved = size;
+	}
+
+	/**
+	 *	Release the reserved address space.
+	 */
+	void release ()
+	{
+		if (m_bytes != NULL)
+		{
+#if defined(_WIN32)
+			VirtualFree(m_bytes, 0, MEM_RELEASE);
+#else
+			munmap(m_bytes, m_reserved);
+#endif
+			m_bytes = NULL;
+		}
+		m_capacity = 0;
+		m_reserved = 0;
+		m_committed = 0;
+	}
+
+	/**
+	 *	Commit whole segments to cover at least the given size.
+	 */
+	void commit (const std::size_t a_size)
+	{
+		const std::size_t size = std::min(m_capacity,
+			(a_size + segment_size - 1) / segment_size * segment_size);
+#if defined(_WIN32)
+		if (VirtualAlloc(m_bytes + m_committed, size - m_committed, MEM_COMMIT,
+					PAGE_READWRITE) == NULL)
+		{
+			throw std::bad_alloc();
+		}
+#else
+		if (mprotect(m_bytes + m_committed, size - m_committed,
+					PROT_READ | PROT_WRITE) != 0)
+		{
+			throw std::bad_alloc();
+		}
+#endif
+		m_committed = size;
+	}
+
+	/**
+	 *	Return the committed memory beyond the given size to the system.
+	 */
+	void decommit (const std::size_t a_size)
+	{
+		if (m_committed <= a_size)
+		{
+			return;
+		}
+#if defined(_WIN32)
+		VirtualFree(m_bytes + a_size, m_committed - a_size, MEM_DECOMMIT);
+#else
+		// NOTE: Mapping fresh anonymous pages over the range discards its
+		//		 contents along with the physical memory backing it.
+		mmap(m_bytes + a_size, m_committed - a_size, PROT_NONE,
+				MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_FIXED, -1, 0);
+#endif
+		m_committed = a_size;
 	}
 
 };
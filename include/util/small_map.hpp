@@ -0,0 +1,395 @@
+/*
+ * @file $/include/util/small_map.hpp
+ *
+This file is a part of the "nParse" project -
+        a general purpose parsing framework, version 0.1.8
+
+The MIT License (MIT)
+Copyright (c) 2007-2017 Alex Kudinov <alex.s.kudinov@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef UTIL_SMALL_MAP_HPP_
+#define UTIL_SMALL_MAP_HPP_
+
+#include <new>
+#include <utility>
+#include <iterator>
+#include <boost/unordered_map.hpp>
+
+namespace utility {
+
+/**
+ *	Associative container for a handful of entries.
+ *
+ *	The entries are kept in chunks of contiguous storage, and looked up by a
+ *	linear scan, which is cheaper than hashing for a few keys. Both lookup and
+ *	iteration go in the reverse order of insertion. The chunks (the first one
+ *	holds N_ entries, and each next one is twice as large as the previous one)
+ *	are drawn from the given byte pool on demand, so that an empty container
+ *	takes a few words only, and a small container that lives in a pool does not
+ *	touch the heap. Once the container outgrows the pool chunks, further chunks
+ *	come from the heap, and the entries get indexed by a hash table. Entries
+ *	never move, thus the references to them stay valid until the container is
+ *	cleared.
+ *
+ *	NOTE: Entries are never erased one by one.
+ */
+template <typename Key_, typename Value_, typename Pool_, std::size_t N_ = 2>
+class small_map
+{
+public:
+	typedef Key_ key_type;
+	typedef Value_ mapped_type;
+	typedef std::pair<const Key_, Value_> value_type;
+
+private:
+	/**
+	 *	A chunk of entry storage.
+	 */
+	struct chunk
+	{
+		chunk* next;
+		value_type* data;
+		std::size_t size;
+		std::size_t capacity;
+
+	};
+
+	/**
+	 *	A forward iterator over the entries.
+	 */
+	template <typename Entry_>
+	class basic_iterator:
+		public std::iterator<std::forward_iterator_tag, Entry_>
+	{
+	public:
+		basic_iterator ():
+			m_chunk (NULL), m_index (0)
+		{
+		}
+
+		basic_iterator (const chunk* a_chunk, const std::size_t a_index):
+			m_chunk (a_chunk), m_index (a_index)
+		{
+		}
+
+		template <typename Other_>
+		basic_iterator (const basic_iterator<Other_>& a_iter):
+			m_chunk (a_iter. m_chunk), m_index (a_iter. m_index)
+		{
+		}
+
+		Entry_& operator* () const
+		{
+			return m_chunk -> data[m_index - 1];
+		}
+
+		Entry_* operator-> () const
+		{
+			return m_chunk -> data + m_index - 1;
+		}
+
+		basic_iterator& operator++ ()
+		{
+			if (-- m_index == 0)
+			{
+				m_chunk = m_chunk -> next;
+				m_index = m_chunk ? m_chunk -> size : 0;
+			}
+			return *this;
+		}
+
+		basic_iterator operator++ (int)
+		{
+			const basic_iterator tmp = *this;
+			++ *this;
+			return tmp;
+		}
+
+		template <typename Other_>
+		bool operator== (const basic_iterator<Other_>& a_iter) const
+		{
+			return m_chunk == a_iter. m_chunk && m_index == a_iter. m_index;
+		}
+
+		template <typename Other_>
+		bool operator!= (const basic_iterator<Other_>& a_iter) const
+		{
+			return ! (*this == a_iter);
+		}
+
+	private:
+		template <typename Other_> friend class basic_iterator;
+
+		const chunk* m_chunk;
+		std::size_t m_index; /**< entry index within the chunk plus one */
+
+	};
+
+public:
+	typedef basic_iterator<value_type> iterator;
+	typedef basic_iterator<const value_type> const_iterator;
+
+public:
+	/**
+	 *	The default constructor.
+	 *
+	 *	@param	a_pool
+	 *		Byte pool for the entries, or NULL
+	 */
+	explicit small_map (Pool_* a_pool = NULL):
+		m_pool (a_pool), m_size (0), m_newest (NULL), m_index (NULL)
+	{
+	}
+
+	/**
+	 *	The copy constructor (the copy draws from the same pool).
+	 */
+	small_map (const small_map& a_map):
+		m_pool (a_map. m_pool), m_size (0), m_newest (NULL), m_index (NULL)
+	{
+		assign(a_map);
+	}
+
+	/**
+	 *	The destructor.
+	 */
+	~small_map ()
+	{
+		clear();
+	}
+
+	/**
+	 *	The assignment operator.
+	 */
+	small_map& operator= (const small_map& a_map)
+	{
+		if (this != &a_map)
+		{
+			clear();
+			assign(a_map);
+		}
+		return *this;
+	}
+
+public:
+	iterator begin ()
+	{
+		return iterator(m_newest, m_newest ? m_newest -> size : 0);
+	}
+
+	const_iterator begin () const
+	{
+		return const_iterator(m_newest, m_newest ? m_newest -> size : 0);
+	}
+
+	iterator end ()
+	{
+		return iterator();
+	}
+
+	const_iterator end () const
+	{
+		return const_iterator();
+	}
+
+	std::size_t size () const
+	{
+		return m_size;
+	}
+
+	bool empty () const
+	{
+		return m_size == 0;
+	}
+
+	/**
+	 *	Find the entry of the given key.
+	 */
+	iterator find (const key_type& a_key)
+	{
+		if (m_index != NULL)
+		{
+			const typename index_type::const_iterator found =
+				m_index -> find(a_key);
+			return found != m_index -> end()
+				? iterator(found -> second. first, found -> second. second)
+				: end();
+		}
+		for (const chunk* c = m_newest; c != NULL; c = c -> next)
+		{
+			for (std::size_t i = c -> size; i > 0; -- i)
+			{
+				if (c -> data[i - 1]. first == a_key)
+				{
+					return iterator(c, i);
+				}
+			}
+		}
+		return end();
+	}
+
+	const_iterator find (const key_type& a_key) const
+	{
+		return const_cast<small_map*>(this) -> find(a_key);
+	}
+
+	/**
+	 *	Insert an entry unless there is one of the same key already.
+	 *
+	 *	@return
+	 *		Iterator pointing to the entry of the key, and whether it has been
+	 *		inserted
+	 */
+	std::pair<iterator, bool> insert (const value_type& a_value)
+	{
+		const iterator found = find(a_value. first);
+		if (found != end())
+		{
+			return std::make_pair(found, false);
+		}
+		return std::make_pair(append(a_value), true);
+	}
+
+	/**
+	 *	Remove all the entries, and give the drawn storage back.
+	 */
+	void clear ()
+	{
+		chunk* c = m_newest;
+		while (c != NULL)
+		{
+			chunk* next = c -> next;
+			for (std::size_t i = 0; i < c -> size; ++ i)
+			{
+				c -> data[i]. ~value_type();
+			}
+			release(c);
+			c = next;
+		}
+		delete m_index;
+		m_index = NULL;
+		m_size = 0;
+		m_newest = NULL;
+	}
+
+private:
+	/**
+	 *	The capacity of the chunks that are drawn from the heap.
+	 */
+	static const std::size_t heap_capacity = N_ * 8;
+
+	typedef boost::unordered_map<key_type,
+			std::pair<const chunk*, std::size_t> > index_type;
+
+	Pool_* m_pool;
+	std::size_t m_size;
+	chunk* m_newest;
+	index_type* m_index; /**< entry index of a large container */
+
+	iterator append (const value_type& a_value)
+	{
+		if (m_newest == NULL || m_newest -> size == m_newest -> capacity)
+		{
+			grow();
+		}
+		new(m_newest -> data + m_newest -> size) value_type(a_value);
+		++ m_size;
+		const iterator result(m_newest, ++ m_newest -> size);
+		if (m_index != NULL)
+		{
+			(*m_index)[a_value. first] =
+				std::make_pair(m_newest, m_newest -> size);
+		}
+		return result;
+	}
+
+	static std::size_t chunk_size (const std::size_t a_capacity)
+	{
+		return sizeof(chunk) + a_capacity * sizeof(value_type);
+	}
+
+	void grow ()
+	{
+		const std::size_t capacity = m_newest ? m_newest -> capacity * 2 : N_;
+		void* ptr = m_pool && capacity < heap_capacity
+			? m_pool -> allocate(chunk_size(capacity))
+			: ::operator new(chunk_size(capacity));
+		chunk* c = static_cast<chunk*>(ptr);
+		c -> next = m_newest;
+		c -> data = static_cast<value_type*>(
+				static_cast<void*>(static_cast<char*>(ptr) + sizeof(chunk)));
+		c -> size = 0;
+		c -> capacity = capacity;
+		m_newest = c;
+		if (capacity >= heap_capacity && m_index == NULL)
+		{
+			m_index = new index_type();
+			for (const chunk* i = c -> next; i != NULL; i = i -> next)
+			{
+				for (std::size_t j = 0; j < i -> size; ++ j)
+				{
+					m_index -> insert(std::make_pair(i -> data[j]. first,
+								std::make_pair(i, j + 1)));
+				}
+			}
+		}
+	}
+
+	void release (chunk* a_chunk)
+	{
+		if (m_pool && a_chunk -> capacity < heap_capacity)
+		{
+			// NOTE: A segment that can not be reclaimed stays in the pool
+			//		 until the pool gets cleared.
+			m_pool -> reclaim(a_chunk, chunk_size(a_chunk -> capacity));
+		}
+		else
+		{
+			::operator delete(a_chunk);
+		}
+	}
+
+	void assign (const small_map& a_map)
+	{
+		if (a_map. m_newest != NULL)
+		{
+			assign(a_map. m_newest);
+		}
+	}
+
+	void assign (const chunk* a_chunk)
+	{
+		// NOTE: The chunks are copied starting from the oldest one, so that the
+		//		 copy keeps the order of insertion.
+		if (a_chunk -> next != NULL)
+		{
+			assign(a_chunk -> next);
+		}
+		for (std::size_t i = 0; i < a_chunk -> size; ++ i)
+		{
+			append(a_chunk -> data[i]);
+		}
+	}
+
+};
+
+} // namespace utility
+
+#endif /* UTIL_SMALL_MAP_HPP_ */
@@ -24,20 +24,95 @@ COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
 IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
 CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
-#include <assert.h>
-#include <stdexcept>
-#include <boost/unordered_map.hpp>
+#include <boost/atomic.hpp>
 #include <nparse/util/hashed_string.hpp>
 #include <util/hash_gen.hpp>
 
-typedef boost::unordered_map<hashed_string::result_type, std::string> hashes_t;
-hashes_t g_hashes;
+/**
+ *	The table of interned strings.
+ */
+class hashed_string::table
+{
+public:
+	/**
+	 *	Get the record of a string with the given initial hash, interning the
+	 *	string if it has not been interned yet.
+	 */
+	static const record* intern (const std::string& a_str, result_type a_hash)
+	{
+		record* created = NULL;
+
+		// NOTE: Colliding strings are given the subsequent hash values (of the
+		//		 same locality), so that every interned string is identified by
+		//		 a unique hash.
+		for ( ; ; a_hash += 2)
+		{
+			boost::atomic_ref<const record*> head(
+					s_buckets[(a_hash >> 1) & bucket_mask]);
+			const record* first = head. load(boost::memory_order_acquire);
+			const record* found = find(first, NULL, a_hash);
+			while (found == NULL)
+			{
+				if (created == NULL)
+				{
+					created = new record();
+					created -> text = a_str;
+				}
+				created -> hash = a_hash;
+				created -> next = first;
+				if (head. compare_exchange_weak(first, created,
+							boost::memory_order_release,
+							boost::memory_order_acquire))
+				{
+					return created;
+				}
+
+				// Check the records published concurrently.
+				found = find(first, created -> next, a_hash);
+			}
+			if (found -> text == a_str)
+			{
+				delete created;
+				return found;
+			}
+		}
+	}
+
+private:
+	static const std::size_t bucket_bits = 12;
+	static const result_type bucket_mask = (1 << bucket_bits) - 1;
+
+	// NOTE: Records are pushed to the heads of the bucket chains without any
+	//		 locking, and the buckets are zero-initialized statically, so that
+	//		 strings can be interned before the dynamic initialization too.
+	static const record* s_buckets[1 << bucket_bits];
+
+	/**
+	 *	Find a record with the given hash within a part of a bucket chain.
+	 */
+	static const record* find (const record* a_first, const record* a_last,
+			const result_type a_hash)
+	{
+		for (const record* r = a_first; r != a_last; r = r -> next)
+		{
+			if (r -> hash == a_hash)
+			{
+				return r;
+			}
+		}
+		return NULL;
+	}
+
+};
+
+const hashed_string::record* hashed_string::table::s_buckets[
+	1 << hashed_string::table::bucket_bits];
 
 void hashed_string::init (const std::string& a_str)
 {
 	if (a_str. empty())
 	{
-		m_hash = 0;
+		m_record = NULL;
 		return;
 	}
 
@@ -45,43 +120,13 @@ void hashed_string::init (const std::string& a_str)
 		utility::hash_gen<hashed_string::result_type>::f(a_str. begin(), a_str. end())
 			<< 1;
 
-	if (*a_str. begin() == '_')
-	{
-		m_hash = h | 1;
-	}
-	else
-	{
-		m_hash = h & ~static_cast<hashed_string::result_type>(1);
-	}
-
-	hashes_t::const_iterator found_at;
-	while	(	(found_at = g_hashes. find(m_hash)) != g_hashes. end()
-			&&	found_at -> second != a_str
-			)
-	{
-		m_hash += 2;
-	}
-
-	if (found_at == g_hashes. end())
-	{
-		const std::pair<hashes_t::iterator, bool> p = g_hashes. insert(
-				hashes_t::value_type(m_hash, a_str));
-		assert(p. second);
-	}
+	m_record = table::intern(a_str, (*a_str. begin() == '_')
+			?	h | 1
+			:	h & ~static_cast<hashed_string::result_type>(1));
 }
 
-hashed_string::operator const std::string& () const
+const std::string& hashed_string::empty_text ()
 {
-	if (m_hash != 0)
-	{
-		hashes_t::const_iterator found_at = g_hashes. find(m_hash);
-		if (found_at == g_hashes. end())
-			throw std::logic_error("hashed_string: inconsistency detected");
-		return found_at -> second;
-	}
-	else
-	{
-		static const std::string sc_empty = std::string();
-		return sc_empty;
-	}
+	static const std::string sc_empty = std::string();
+	return sc_empty;
 }
@@ -27,6 +27,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #ifndef SRC_ACTION_STRING_HPP_
 #define SRC_ACTION_STRING_HPP_
 
+#include <vector>
 #include <boost/regex.hpp>
 #include <boost/lexical_cast.hpp>
 #include <nparse/util/offset_state.hpp>
@@ -75,60 +76,108 @@ class ActionString: public IAction
 
 	};
 
-	// An auxiliary template object that does variable substitutions.
-	template <typename Context_>
-	class formatter
+	// A piece of the stored string pattern.
+	struct segment
 	{
-		const Context_& m_ctx;
-		typedef typename Context_::key_type key_type;
-
-	public:
-		formatter (const Context_& a_ctx):
-			m_ctx (a_ctx)
+		enum kind_type
+		{
+			TEXT, /**< literal text */
+			RANGE, /**< accepted range at a placeholder offset */
+			VARIABLE /**< value of a trace variable */
+		};
+
+		kind_type kind;
+		string_t text;
+		int offset;
+		IEnvironment::key_type key;
+
+		segment (const kind_type a_kind):
+			kind (a_kind), offset (0)
 		{
 		}
 
-		template <typename Match_>
-		nlg_string_t operator() (const Match_& a_match) const
+	};
+
+	typedef std::vector<segment> segments_t;
+
+	/**
+	 *	Split the stored string pattern into segments.
+	 */
+	void compile ()
+	{
+		static const string_t def("\\$(\\$|\\w+|\\{\\w*\\})?");
+		static const boost::basic_regex<string_t::value_type> pattern(def);
+		typedef boost::regex_iterator<string_t::const_iterator> iterator_t;
+
+		const string_t& str = m_string;
+		string_t::const_iterator last = str. begin();
+		for (iterator_t i(str. begin(), str. end(), pattern), end;
+				i != end; ++ i)
 		{
-			static const nlg_string_t dollar("$");
-			const nlg_string_t str = a_match[1]. str();
-			if	(	str. empty()
-				||	(str. size() == 2 && str[0] == L'{' && str[1] == L'}')
+			const iterator_t::value_type& match = *i;
+			append_text(string_t(last, match[0]. first));
+			last = match[0]. second;
+
+			const string_t group = match[1]. str();
+			if	(	group. empty()
+				||	(group. size() == 2 && group[0] == L'{' && group[1] == L'}')
 				)
 			{
 				// Substitute the last accepted range.
-				return get_range<Context_>::f(m_ctx);
+				m_segments. push_back(segment(segment::RANGE));
+				continue;
 			}
 			else
-			if (str == dollar)
+			if (group == string_t("$"))
 			{
 				// Substitute the dollar sign.
-				return dollar;
+				append_text(group);
+				continue;
 			}
 
 			// The index can be optionally enclosed in curly brackets.
-			const nlg_string_t index = (str[0] == L'{')
-				?	nlg_string_t(str. begin()+1, str. begin()+(str. size()-1))
-				:	nlg_string_t(str);
+			const string_t index = (group[0] == L'{')
+				?	string_t(group. begin()+1, group. begin()+(group. size()-1))
+				:	group;
 
 			// If the index is represented by an integer value, then it should
 			// be treated as a placeholder offset, otherwise the index should be
 			// treated and as a context key.
-
-			for (nlg_string_t::const_iterator c = index. begin();
-					c != index. end(); ++ c)
+			string_t::const_iterator c = index. begin();
+			while (c != index. end() && std::isdigit(*c))
 			{
-				if (! std::isdigit(*c))
-					return m_ctx. val(key_type(index)). as_string();
+				++ c;
+			}
+			if (c == index. end())
+			{
+				m_segments. push_back(segment(segment::RANGE));
+				m_segments. back(). offset =
+					boost::lexical_cast<int>(encode::unwrap(index));
+			}
+			else
+			{
+				m_segments. push_back(segment(segment::VARIABLE));
+				m_segments. back(). key = IEnvironment::key_type(index);
 			}
-
-			// Substitute an accepted range at the specified offset.
-			return get_range<Context_>::f(
-					m_ctx, boost::lexical_cast<int>(encode::unwrap(index)));
 		}
+		append_text(string_t(last, str. end()));
+	}
 
-	};
+	/**
+	 *	Append a literal text to the segments.
+	 */
+	void append_text (const string_t& a_text)
+	{
+		if (a_text. empty())
+		{
+			return;
+		}
+		if (m_segments. empty() || m_segments. back(). kind != segment::TEXT)
+		{
+			m_segments. push_back(segment(segment::TEXT));
+		}
+		m_segments. back(). text += a_text;
+	}
 
 public:
 	/**
@@ -137,10 +186,26 @@ public:
 	template <typename Context_>
 	string_t eval (const Context_& a_ctx) const
 	{
-		static const string_t def("\\$(\\$|\\w+|\\{\\w*\\})?");
-		static const boost::basic_regex<string_t::value_type> pattern(def);
-		return boost::regex_replace(m_string, pattern,
-				formatter<Context_>(a_ctx));
+		string_t result;
+		for (segments_t::const_iterator s = m_segments. begin();
+				s != m_segments. end(); ++ s)
+		{
+			switch (s -> kind)
+			{
+			case segment::TEXT:
+				result += s -> text;
+				break;
+
+			case segment::RANGE:
+				result += get_range<Context_>::f(a_ctx, s -> offset);
+				break;
+
+			case segment::VARIABLE:
+				result += a_ctx. val(s -> key). as_string();
+				break;
+			}
+		}
+		return result;
 	}
 
 public:
@@ -158,11 +223,17 @@ public:
 	ActionString (const anta::range<SG>::type& a_range)
 	{
 		m_string = Tokenizer::decode(a_range. first, a_range. second);
+		compile();
 	}
 
 private:
 	string_t m_string; /**< stored string pattern */
 
+	// NOTE: The pattern is split into segments once, so that substitutions
+	//		 are neither searched for nor have their keys hashed every time the
+	//		 string is evaluated.
+	segments_t m_segments; /**< compiled string pattern */
+
 };
 
 } // namespace
@@ -138,8 +138,7 @@ public:
 		// Save previous context as the result in another special variable.
 		if (! m_alias. empty())
 		{
-			const IEnvironment::key_type key(m_alias);
-			processor. ref(key, true) =
+			processor. ref(m_alias, true) =
 				anta::aux::array<NLG>::type(a_env. create(self));
 		}
 
@@ -155,7 +154,7 @@ public:
 	}
 
 private:
-	string_t m_alias;
+	IEnvironment::key_type m_alias;
 	action_pointer m_cond;
 
 };
@@ -26,6 +26,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
 #include <sstream>
 #include <algorithm>
+#include <boost/thread/mutex.hpp>
 #include <nparse/nparse.hpp>
 #include <nparse/util/linked_action.hpp>
 #include <anta/sas/regex.hpp>
@@ -80,6 +81,14 @@ private:
 	{
 		if (! m_function)
 		{
+			// NOTE: The action may be evaluated by concurrent parsers, so the
+			//		 function is instantiated and linked exactly once.
+			boost::mutex::scoped_lock lock(m_mutex);
+			if (m_function)
+			{
+				return *m_function;
+			}
+
 			plugin::IPluggable* ptr =
 				plugin::IManager::instance(). create(m_name);
 			if (! ptr)
@@ -93,8 +102,9 @@ private:
 					<< ex::location(where)
 					<< ex::message("undefined function or procedure");
 			}
-			m_function = dynamic_cast<IFunction*>(ptr);
-			m_function -> link(m_staging, m_namespace);
+			IFunction* function = dynamic_cast<IFunction*>(ptr);
+			function -> link(m_staging, m_namespace);
+			m_function = function;
 		}
 		return *m_function;
 	}
@@ -104,6 +114,7 @@ private:
 	string_t m_namespace;
 	IFunction::arguments_type m_arguments;
 	mutable IFunction* m_function;
+	mutable boost::mutex m_mutex;
 
 };
 
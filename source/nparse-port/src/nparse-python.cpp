@@ -163,6 +163,14 @@ public:
 		return Parser::parse(m_text. data(), m_text. size());
 	}
 
+	bool reparse (const int a_edit_begin, const int a_edit_end,
+			const char* a_text)
+	{
+		const std::wstring text(encode::wstring(a_text));
+		return Parser::reparse(a_edit_begin, a_edit_end,
+				text. data(), text. size());
+	}
+
 	Variable get_all () const
 	{
 		return get();
@@ -230,6 +238,8 @@ BOOST_PYTHON_MODULE(nparse)
 				(bool(PParser::*)(const char*))
 				&PParser::parse<const char*>)
 
+		.def("reparse",				&PParser::reparse)
+
 		.def("next",				&PParser::next)
 
 		.def("step",				&PParser::step)
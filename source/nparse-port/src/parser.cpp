@@ -58,6 +58,10 @@ struct ParserData
 	std::string entry_point;
 	long entry_label;
 	long lr_threshold;
+	bool memoize;
+	long beam_width;
+	long max_traces;
+	bool merge;
 
 	// initial values of trace variables
 	typedef std::map<
@@ -65,6 +69,9 @@ struct ParserData
 		anta::ndl::context_value<NLG>::type> init_t;
 	init_t init;
 
+	// input text (kept for re-parsing)
+	std::wstring input;
+
 	// active elements
 	boost::scoped_ptr<anta::Processor<NLG> > processor;
 	boost::scoped_ptr<anta::aux::Tracer<NLG> > tracer;
@@ -88,6 +95,10 @@ struct ParserData
 		entry_point ("S"),
 		entry_label (1),
 		lr_threshold (64),
+		memoize (false),
+		beam_width (0),
+		max_traces (0),
+		merge (false),
 		// stats
 		iteration_count (0),
 		shift (0),
@@ -101,6 +112,10 @@ struct ParserData
 			("entry_point", entry_point)
 			("entry_label", entry_label)
 			("lr_threshold", lr_threshold)
+			("memoize", memoize)
+			("beam_width", beam_width)
+			("max_traces", max_traces)
+			("merge", merge)
 			(init); // fallback
 		staging = staging_factory -> createInstance();
 	}
@@ -117,9 +132,51 @@ struct ParserData
 #endif
 		processor -> set_capacity(input_pool << 10);
 		processor -> set_lr_threshold(lr_threshold);
+		processor -> set_memoization(memoize);
+		processor -> set_beam_width(static_cast<anta::uint_t>(beam_width));
+		processor -> set_max_traces(static_cast<anta::uint_t>(max_traces));
+		processor -> set_merging(merge);
 		tracer. reset(new anta::aux::Tracer<NLG>(*processor));
 	}
 
+	bool run ()
+	{
+		if (config. changed())
+		{
+			config. update();
+			activate(); // reactivate on configuration change
+		}
+
+		try
+		{
+			status = Parser::stRunning;
+			processor -> init(input. data(), input. data() + input. size());
+			for (init_t::const_iterator i = init. begin(); i != init. end();
+					++ i)
+			{
+				processor -> ref(i -> first) = i -> second;
+			}
+			iteration_count = processor -> run();
+			first_trace = tracer -> next();
+			status = Parser::stCompleted;
+			return true;
+		}
+		catch (const std::bad_alloc&)
+		{
+			report(std::runtime_error("input pool overflow"));
+		}
+		catch (const std::exception& err)
+		{
+			report(err);
+		}
+		catch (ex::generic_error& err)
+		{
+			report(err, Parser::stRuntimeError);
+		}
+
+		return false;
+	}
+
 	bool validate (const Parser::status_t a_status)
 	{
 		if (status != a_status)
@@ -388,42 +445,39 @@ bool Parser::parse (const wchar_t* a_input, const int a_len)
 		return false;
 	}
 
-	if (m_ -> config. changed())
-	{
-		m_ -> config. update();
-		m_ -> activate(); // reactivate on configuration change
-	}
+	m_ -> input. assign(a_input, a_len ? a_len : wcslen(a_input));
+	return m_ -> run();
+}
 
-	try
-	{
-		m_ -> status = stRunning;
-		m_ -> processor -> init(
-				a_input,
-				a_input + (a_len ? a_len : wcslen(a_input)));
-		for (ParserData::init_t::const_iterator i = m_ -> init. begin();
-				i != m_ -> init. end(); ++ i)
-		{
-			m_ -> processor -> ref(i -> first) = i -> second;
-		}
-		m_ -> iteration_count = m_ -> processor -> run();
-		m_ -> first_trace = m_ -> tracer -> next();
-		m_ -> status = stCompleted;
-		return true;
-	}
-	catch (const std::bad_alloc&)
+bool Parser::reparse (const int a_edit_begin, const int a_edit_end,
+		const wchar_t* a_text, const int a_len)
+{
+	if (! m_ -> validate(stCompleted))
 	{
-		m_ -> report(std::runtime_error("input pool overflow"));
+		return false;
 	}
-	catch (const std::exception& err)
+
+	if (a_edit_begin < 0 || a_edit_end < a_edit_begin
+			|| static_cast<std::size_t>(a_edit_end) > m_ -> input. size())
 	{
-		m_ -> report(err);
+		m_ -> status = stLogicError;
+		return false;
 	}
-	catch (ex::generic_error& err)
+
+	// An edit that leaves the input text intact keeps the found traces.
+	const std::size_t pos = static_cast<std::size_t>(a_edit_begin);
+	const std::size_t n = static_cast<std::size_t>(a_edit_end - a_edit_begin);
+	const std::size_t len = a_len ? a_len : wcslen(a_text);
+	if (! m_ -> config. changed()
+			&& m_ -> input. compare(pos, n, a_text, len) == 0)
 	{
-		m_ -> report(err, stRuntimeError);
+		rewind();
+		return true;
 	}
 
-	return false;
+	reset();
+	m_ -> input. replace(pos, n, a_text, len);
+	return m_ -> run();
 }
 
 bool Parser::next ()
@@ -703,7 +757,7 @@ const char* Parser::get_location (const int a_index, int* a_line, int* a_offset)
 unsigned long Parser::get_trace_count () const
 {
 	return m_ -> validate(stCompleted)
-		? static_cast<unsigned long>(m_ -> processor -> get_traced(). size())
+		? static_cast<unsigned long>(m_ -> processor -> get_trace_count())
 		: 0;
 }
 
@@ -0,0 +1,164 @@
+/*
+ * @file $/source/nparse-test/src/test_context.cpp
+ *
+This file is a part of the "nParse" project -
+        a general purpose parsing framework, version 0.1.8
+
+The MIT License (MIT)
+Copyright (c) 2007-2017 Alex Kudinov <alex.s.kudinov@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#define ANTA_NDL_MUTABLE_ANCESTOR
+
+#include <string>
+#include <vector>
+#include <iterator>
+#include <gtest/gtest.h>
+#include <anta/ndl.hpp>
+
+/**
+ *	Test model definition.
+ */
+namespace {
+
+struct M1: public anta::ndl::extend<anta::model<> >::type {};
+
+typedef anta::ndl::Context<M1> context_t;
+typedef anta::ndl::context_entry<M1>::type entry_t;
+
+std::string key (const int a_index)
+{
+	return std::string("v") + char('a' + a_index % 26)
+		+ char('a' + a_index / 26);
+}
+
+/**
+ *	Test fixture: holds a context owner and builds chains of contexts.
+ */
+class test_context: public ::testing::Test
+{
+protected:
+	anta::ndl::ContextOwner<M1> owner;
+
+	test_context ()
+	{
+		owner. set_capacity(1 << 20);
+	}
+
+	/**
+	 *	Derive the given number of contexts, each defining a single variable
+	 *	of the given keys (in a round robin manner).
+	 */
+	context_t* chain (context_t* a_context, const int a_length,
+			const int a_keys)
+	{
+		for (int i = 0; i < a_length; ++ i)
+		{
+			a_context = a_context -> derive();
+			a_context -> ref(key(i % a_keys)) = key(i);
+		}
+		return a_context;
+	}
+
+	static std::vector<std::string> list (const context_t* a_context)
+	{
+		std::vector<entry_t> entries;
+		a_context -> list(std::back_inserter(entries));
+		std::vector<std::string> result;
+		for (std::vector<entry_t>::const_iterator i = entries. begin();
+				i != entries. end(); ++ i)
+		{
+			result. push_back(i -> first + "=" + i -> second);
+		}
+		return result;
+	}
+
+};
+
+} // namespace
+
+TEST_F(test_context, deep_lookup)
+{
+	context_t* root = owner. create(NULL);
+	root -> ref("root") = "yes";
+	const context_t* leaf = chain(root, 100, 30);
+
+	// The innermost definition of a variable wins.
+	for (int i = 0; i < 30; ++ i)
+	{
+		EXPECT_EQ(key(i < 10 ? 90 + i : 60 + i), leaf -> val(key(i)));
+	}
+	EXPECT_EQ("yes", leaf -> val("root"));
+	EXPECT_EQ("", leaf -> val("none"));
+	EXPECT_TRUE(leaf -> is_defined("root", anta::ndl::pTrue()));
+	EXPECT_FALSE(leaf -> is_defined("none", anta::ndl::pTrue()));
+}
+
+TEST_F(test_context, late_definition)
+{
+	context_t* root = owner. create(NULL);
+	context_t* middle = chain(root, 20, 5);
+	const context_t* leaf = chain(middle, 20, 5);
+	EXPECT_EQ("", leaf -> val("late"));
+
+	// Variables defined by ancestors after derivation are visible too.
+	root -> ref("late") = "root";
+	EXPECT_EQ("root", leaf -> val("late"));
+	middle -> ref("late") = "middle";
+	EXPECT_EQ("middle", leaf -> val("late"));
+	EXPECT_EQ("root", root -> derive() -> val("late"));
+}
+
+TEST_F(test_context, listing)
+{
+	context_t* root = owner. create(NULL);
+	root -> ref("a") = "1";
+	root -> ref("b") = "2";
+	context_t* leaf = chain(root, 40, 3);
+	leaf -> ref("b") = "3";
+
+	// Each variable is listed once, the innermost definitions first.
+	std::vector<std::string> expected;
+	expected. push_back("b=3");
+	expected. push_back(key(0) + "=" + key(39));
+	expected. push_back(key(2) + "=" + key(38));
+	expected. push_back(key(1) + "=" + key(37));
+	expected. push_back("a=1");
+	EXPECT_EQ(expected, list(leaf));
+
+	std::vector<entry_t> local;
+	EXPECT_EQ(2u, leaf -> list(std::back_inserter(local), true));
+}
+
+TEST_F(test_context, reparenting)
+{
+	context_t* first = owner. create(NULL);
+	first -> ref("x") = "first";
+	context_t* second = owner. create(NULL);
+	second -> ref("y") = "second";
+	context_t* orphan = owner. create(NULL);
+	const context_t* leaf = chain(orphan, 30, 4);
+	EXPECT_EQ("", leaf -> val("x"));
+
+	orphan -> set_ancestor(first);
+	EXPECT_EQ("first", leaf -> val("x"));
+	orphan -> set_ancestor(second);
+	EXPECT_EQ("", leaf -> val("x"));
+	EXPECT_EQ("second", leaf -> val("y"));
+}
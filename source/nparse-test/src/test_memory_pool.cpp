@@ -0,0 +1,146 @@
+/*
+ * @file $/source/nparse-test/src/test_memory_pool.cpp
+ *
+This file is a part of the "nParse" project -
+        a general purpose parsing framework, version 0.1.8
+
+The MIT License (MIT)
+Copyright (c) 2007-2017 Alex Kudinov <alex.s.kudinov@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <gtest/gtest.h>
+#include <util/memory_pool.hpp>
+
+namespace {
+
+const std::size_t segment = utility::memory_pool::segment_size;
+
+} // namespace
+
+TEST(memory_pool, growth)
+{
+	utility::memory_pool pool;
+	pool. set_capacity(4 * segment);
+	EXPECT_EQ(4 * segment, pool. get_capacity());
+	EXPECT_EQ(0u, pool. get_committed_size());
+
+	// Segments are committed on demand.
+	char* p1 = static_cast<char*>(pool. allocate(segment - 8));
+	EXPECT_EQ(segment, pool. get_committed_size());
+	char* p2 = static_cast<char*>(pool. allocate(16));
+	EXPECT_EQ(2 * segment, pool. get_committed_size());
+
+	// Allocated memory never moves and addresses grow monotonically.
+	EXPECT_EQ(p1 + segment - 8, p2);
+	p1[0] = p1[segment - 9] = p2[0] = p2[15] = 'x';
+	EXPECT_EQ(segment + 8, pool. get_usage());
+	EXPECT_EQ(segment + 8, pool. get_peak_usage());
+}
+
+TEST(memory_pool, eviction)
+{
+	utility::memory_pool pool;
+	pool. set_capacity(4 * segment);
+	void* p1 = pool. allocate(segment - 8);
+	void* p2 = pool. allocate(16);
+
+	// Only the last allocated segment can be evicted, even if it crosses
+	// the boundary of committed segments.
+	EXPECT_FALSE(pool. evict(p1, segment - 8));
+	EXPECT_TRUE(pool. evict(p2, 16));
+	EXPECT_TRUE(pool. evict(p1, segment - 8));
+	EXPECT_EQ(0u, pool. get_usage());
+	EXPECT_EQ(segment + 8, pool. get_evicted_size());
+
+	// Evicted memory is reused.
+	EXPECT_EQ(p1, pool. allocate(8));
+}
+
+TEST(memory_pool, overflow)
+{
+	utility::memory_pool pool;
+	pool. set_capacity(segment + 100);
+	pool. allocate(segment);
+	pool. allocate(100);
+	EXPECT_THROW(pool. allocate(1), std::bad_alloc);
+	EXPECT_THROW(pool. set_capacity(2 * segment), std::logic_error);
+}
+
+TEST(memory_pool, clear)
+{
+	utility::memory_pool pool;
+	pool. set_capacity(8 * segment);
+	char* p1 = static_cast<char*>(pool. allocate(5 * segment));
+	p1[4 * segment] = 'x';
+	EXPECT_EQ(5 * segment, pool. get_committed_size());
+
+	// Committed memory beyond the first segment is returned to the system.
+	pool. clear();
+	EXPECT_EQ(segment, pool. get_committed_size());
+	EXPECT_EQ(0u, pool. get_usage());
+	EXPECT_EQ(0u, pool. get_peak_usage());
+
+	char* p2 = static_cast<char*>(pool. allocate(5 * segment));
+	EXPECT_EQ(p1, p2);
+	EXPECT_EQ(0, p2[4 * segment]);
+}
+
+TEST(memory_pool, reclaim)
+{
+	utility::memory_pool pool;
+	pool. set_capacity(segment);
+	void* p1 = pool. allocate(32);
+	void* p2 = pool. allocate(32);
+	void* p3 = pool. allocate(48);
+	pool. allocate(32);
+
+	// Segments in the middle of the pool are reclaimed for reuse, unless they
+	// are too large or misaligned for a size class.
+	EXPECT_TRUE(pool. reclaim(p2, 32));
+	EXPECT_FALSE(pool. reclaim(p3, 47));
+	EXPECT_EQ(112u, pool. get_usage());
+	EXPECT_EQ(144u, pool. get_peak_usage());
+	EXPECT_EQ(32u, pool. get_evicted_size());
+
+	// A reclaimed segment is only reused above the floor, and allocations keep
+	// growing in address until the floor is set again.
+	pool. set_floor(p2);
+	EXPECT_NE(p2, pool. allocate(32));
+	pool. set_floor(p1);
+	EXPECT_EQ(p2, pool. allocate(32));
+	EXPECT_TRUE(pool. reclaim(p2, 32));
+	EXPECT_NE(p2, pool. allocate(32));
+}
+
+TEST(memory_pool, retraction)
+{
+	utility::memory_pool pool;
+	pool. set_capacity(segment);
+	void* p1 = pool. allocate(32);
+	void* p2 = pool. allocate(16);
+	void* p3 = pool. allocate(24);
+
+	// Eviction of the last segment withdraws the reclaimed ones beneath it.
+	EXPECT_TRUE(pool. reclaim(p2, 16));
+	EXPECT_TRUE(pool. reclaim(p1, 32));
+	EXPECT_TRUE(pool. reclaim(p3, 24));
+	EXPECT_EQ(0u, pool. get_usage());
+	EXPECT_EQ(72u, pool. get_evicted_size());
+	EXPECT_EQ(p1, pool. allocate(24));
+}
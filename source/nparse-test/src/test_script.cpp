@@ -36,6 +36,7 @@ static const char* TAG_INPUT = "input";
 static const char* TAG_CHECK = "check";
 static const char* TAG_ERROR = "error";
 static const char* TAG_FOREST = "forest";
+static const char* TAG_EDIT = "edit";
 
 static char* static_trim (char* str)
 {
@@ -541,6 +542,27 @@ void process_case (const char* a_config_name, const char* a_script,
 	// Parse input text.
 	a_parser. parse(input. data(), input. size());
 
+	// Re-parse the input text after an edit, if requested.
+	std::string text = a_test[TAG_INPUT]. as<std::string>();
+	const YAML::Node& edit = a_test[TAG_EDIT];
+	if (edit. IsDefined())
+	{
+		ASSERT_EQ( YAML::NodeType::Map, get_node_type(edit) )
+			<< "node `" << a_script << " @ " << a_case << '/' << TAG_EDIT
+			<< "' must be a map whenever specified";
+
+		const int begin = edit["begin"]. as<int>(),
+			end = edit["end"]. as<int>();
+		const std::string replacement = edit["text"]. as<std::string>();
+		const std::wstring w_replacement = encode::wstring(replacement);
+
+		ASSERT_EQ( nparse::Parser::stCompleted, a_parser. status() )
+			<< info. str();
+		a_parser. reparse(begin, end, w_replacement. data(),
+				w_replacement. size());
+		text. replace(begin, end - begin, replacement);
+	}
+
 	// Validate runtime-error report.
 	const YAML::Node& error = a_test[TAG_ERROR];
 	if (error. IsDefined())
@@ -582,7 +604,7 @@ void process_case (const char* a_config_name, const char* a_script,
 		process_check(
 			a_script,
 			a_case,
-			a_test[TAG_INPUT]. as<std::string>(). c_str(),
+			text. c_str(),
 			a_parser,
 			check
 		);
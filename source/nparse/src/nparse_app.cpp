@@ -26,9 +26,13 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
 #include <iostream>
 #include <locale>
+#include <limits>
 #include <boost/program_options.hpp>
 #include <boost/regex.hpp>
 #include <boost/lexical_cast.hpp>
+#include <boost/bind.hpp>
+#include <boost/ref.hpp>
+#include <boost/thread/thread.hpp>
 #include <plugin/static.hpp>
 #include <util/free.hpp>
 #include <nparse/_version.hpp>
@@ -172,6 +176,7 @@ nParseApp::nParseApp ():
 	m_input_pool (0),
 	m_input_batch (false),
 	m_entry_label (1),
+	m_jobs (1),
 	m_staging_factory ("nparse.script.StagingFactory")
 {
 	PLUGIN_STATIC_INIT(nparse_script_grammar);
@@ -209,7 +214,7 @@ bool nParseApp::configure (const int argc, char** argv)
 		("input-file,f",		po::value<std::string>(),
 								"Read input from [file]")
 		("input-pool,I",		po::value<long>()
-									-> default_value(1 << 10),
+									-> default_value(64 << 10),
 								"Set input pool size [Kb]")
 #if defined(NPARSE_SWAP_FILE)
 		("input-swap,w",		po::value<std::string>()
@@ -229,6 +234,25 @@ bool nParseApp::configure (const int argc, char** argv)
 		("lr-threshold,r",		po::value<long>()
 									-> default_value(64),
 								"Set or disable LR [threshold]")
+		("memoize,m",			po::value<bool>()
+									-> default_value(false)
+									-> implicit_value(true),
+								"Share results of equivalent invocations")
+		("beam,B",				po::value<long>()
+									-> default_value(0),
+								"Keep up to [width] queued states per input"
+								" position")
+		("max-traces,n",		po::value<long>()
+									-> default_value(0),
+								"Stop once [count] traces have been found")
+		("merge,M",				po::value<bool>()
+									-> default_value(false)
+									-> implicit_value(true),
+								"Merge equivalent states")
+		("jobs,j",				po::value<long>()
+									-> default_value(1),
+								"Parse up to [count] batch entries"
+								" concurrently")
 #if defined(DEBUG_PRINT)
 		("debug-print,d",		po::value<std::string>()
 									-> default_value("")
@@ -467,6 +491,11 @@ bool nParseApp::configure (const int argc, char** argv)
 	m_entry_point = vm["entry-point"]. as<std::string>();
 	m_entry_label = vm["entry-label"]. as<int>();
 	m_lr_threshold = vm["lr-threshold"]. as<long>();
+	m_memoize = vm["memoize"]. as<bool>();
+	m_beam_width = vm["beam"]. as<long>();
+	m_max_traces = vm["max-traces"]. as<long>();
+	m_merge = vm["merge"]. as<bool>();
+	m_jobs = vm["jobs"]. as<long>();
 #if defined(DEBUG_PRINT)
 	m_debug_print = vm["debug-print"]. as<std::string>();
 #endif
@@ -481,6 +510,34 @@ bool nParseApp::configure (const int argc, char** argv)
 		m_out = vm["out"]. as<std::vector<std::string> >();
 	}
 
+	// Verify that the batch entries can be parsed concurrently.
+	if (m_jobs < 1)
+	{
+		throw std::runtime_error("jobs count must be positive");
+	}
+	if (m_jobs > 1)
+	{
+		if (! m_input_batch)
+		{
+			throw std::runtime_error("jobs program option requires batch"
+					" input");
+		}
+#if defined(NPARSE_SWAP_FILE)
+		if (! m_input_swap. empty())
+		{
+			throw std::runtime_error("input-swap and jobs program options"
+					" can not be specified at the same time");
+		}
+#endif
+#if defined(DEBUG_PRINT)
+		if (! m_debug_print. empty())
+		{
+			throw std::runtime_error("debug-print and jobs program options"
+					" can not be specified at the same time");
+		}
+#endif
+	}
+
 	return true;
 }
 
@@ -643,50 +700,49 @@ int nParseApp::compile_grammar ()
 	return 0;
 }
 
-int nParseApp::parse_input_text ()
+/**
+ *	A batch entry parsed by a dedicated processor in the multi-threaded mode.
+ */
+struct nParseApp::job
 {
-	// Create processor and link it to the compiled grammar's entry point.
-	anta::Processor<NLG> processor(m_staging -> cluster(m_entry_point),
-			m_entry_label);
-#if defined(DEBUG_PRINT)
-	if (! m_debug_print. empty())
+	anta::Processor<NLG> processor;
+	TracerNLG tracer;
+	nlg_string_t line;
+	dt_t parse_time;
+	anta::uint_t iteration_count;
+	boost::shared_ptr<ex::generic_error> error;
+	std::string failure;
+
+	job (const anta::Node<NLG>& a_entry_node, const int a_entry_label):
+		processor (a_entry_node, a_entry_label),
+		tracer (processor),
+		iteration_count (0)
 	{
-		processor. get_observer(). link(open_file(m_debug_print));
 	}
-#endif
-#if defined(NPARSE_SWAP_FILE)
-	if (! m_input_swap. empty())
+
+};
+
+int nParseApp::parse_input_text ()
+{
+	if (m_jobs > 1)
 	{
-		processor. set_swap_file(m_input_swap);
+		return parse_input_batch();
 	}
-#endif
-	processor. set_capacity(m_input_pool);
-	processor. set_lr_threshold(m_lr_threshold);
+
+	// Create processor and link it to the compiled grammar's entry point.
+	anta::Processor<NLG> processor(m_staging -> cluster(m_entry_point),
+			m_entry_label);
+	configure_processor(processor);
 
 	// Create tracer and link it to the processor.
 	TracerNLG tracer(processor);
 	tracer. format(m_trace_format);
 
-	std::string buf;
-	while (std::getline(*m_input_stream, buf, m_input_batch ? '\n' : '\x00'))
+	nlg_string_t line;
+	while (read_record(line, m_input_batch ? '\n' : '\x00'))
 	{
-		// Implicit narrow/wide string conversion may take place here.
-		const nlg_string_t& line = buf;
-
-		// Prepare input text range.
-		anta::range<NLG>::type src;
-		src. first = &* line. begin();
-		src. second = src. first + line. size();
-
 		// Initialize the processor.
-		processor. init(src. first, src. second);
-
-		// Assign initial values to trace variables.
-		for (init_t::const_iterator i = m_init. begin(); i != m_init. end();
-				++ i)
-		{
-			processor. ref(i -> first) = i -> second;
-		}
+		init_processor(processor, line);
 
 		// Parse input text.
 		dt_t parse_time = ch::seconds(0);
@@ -706,29 +762,214 @@ int nParseApp::parse_input_text ()
 			rethrow(err, *m_staging);
 		}
 
-		// Unroll and print traces.
-		print_traces(tracer);
+		// Print the parsing results.
+		print_results(tracer, processor, parse_time, total_iteration_count);
 
-		// Print syntax tree.
-		print_syntax_tree(tracer);
+		// Reset intermediate objects (not really necessary here).
+		tracer. rewind();
+		processor. reset();
+	}
 
-		// Print final states.
-		print_final_states(processor);
+	return 0;
+}
 
-		// Print explicitly specified variables.
-		print_variables(processor);
+int nParseApp::parse_input_batch ()
+{
+	typedef std::vector<boost::shared_ptr<job> > jobs_t;
+
+	// Create a processor with its own state pool for each concurrent job.
+	// NOTE: The acceptor network is shared by all processors, which only read
+	//		 it, whereas states and trace contexts never leave their pools.
+	const anta::Node<NLG>& entry_node = m_staging -> cluster(m_entry_point);
+	jobs_t jobs;
+	jobs. reserve(m_jobs);
+	for (long n = 0; n < m_jobs; ++ n)
+	{
+		jobs. push_back(boost::shared_ptr<job>(new job(entry_node,
+						m_entry_label)));
+		configure_processor(jobs. back() -> processor);
+		jobs. back() -> tracer. format(m_trace_format);
+	}
 
-		// Print statistics.
-		print_stats(processor, parse_time, total_iteration_count);
+	for (bool more = true; more; )
+	{
+		// Read the next round of entries and parse each one in a separate
+		// thread.
+		boost::thread_group threads;
+		jobs_t::iterator end = jobs. begin();
+		for ( ; end != jobs. end(); ++ end)
+		{
+			if (! read_record((*end) -> line, '\n'))
+			{
+				more = false;
+				break;
+			}
+			threads. create_thread(boost::bind(&nParseApp::run_job, this,
+						boost::ref(**end)));
+		}
+		threads. join_all();
 
-		// Reset intermediate objects (not really necessary here).
-		tracer. rewind();
-		processor. reset();
+		// Report errors and print results in the input order.
+		for (jobs_t::iterator j = jobs. begin(); j != end; ++ j)
+		{
+			if ((*j) -> error)
+			{
+				rethrow(*(*j) -> error, *m_staging);
+			}
+			if (! (*j) -> failure. empty())
+			{
+				throw std::runtime_error((*j) -> failure);
+			}
+
+			print_results((*j) -> tracer, (*j) -> processor,
+					(*j) -> parse_time, (*j) -> iteration_count);
+
+			// Reset intermediate objects.
+			(*j) -> tracer. rewind();
+			(*j) -> processor. reset();
+		}
 	}
 
 	return 0;
 }
 
+bool nParseApp::read_record (nlg_string_t& a_line, const char a_delim)
+{
+	// NOTE: The record is read in chunks of limited size, and each chunk gets
+	//		 converted and appended to the line at once, so that the record is
+	//		 never kept in memory in both narrow and wide forms.
+	std::istream& in = *m_input_stream;
+	char chunk[4096];
+	bool found = false;
+	a_line. clear();
+
+	// The length of the record is measured beforehand if the stream is
+	// seekable, so that the line gets allocated only once.
+	const std::istream::pos_type start = in. tellg();
+	if (start != std::istream::pos_type(-1))
+	{
+		in. ignore(std::numeric_limits<std::streamsize>::max(), a_delim);
+		a_line. reserve(static_cast<std::size_t>(in. gcount()));
+		in. clear();
+		in. seekg(start);
+	}
+
+	while (true)
+	{
+		in. get(chunk, sizeof(chunk), a_delim);
+		const std::streamsize count = in. gcount();
+		if (count > 0)
+		{
+			// Implicit narrow/wide string conversion takes place here.
+			a_line. append(nlg_string_t(chunk, chunk + count));
+			found = true;
+		}
+		if (in. eof())
+		{
+			return found;
+		}
+
+		// NOTE: The failbit gets set if the delimiter comes first.
+		in. clear();
+		if (in. peek() == std::char_traits<char>::to_int_type(a_delim))
+		{
+			in. ignore();
+			return true;
+		}
+	}
+}
+
+void nParseApp::run_job (job& a_job)
+{
+	a_job. parse_time = ch::seconds(0);
+	a_job. iteration_count = 0;
+	a_job. error. reset();
+	a_job. failure. clear();
+
+	// NOTE: Exceptions must not escape the worker thread, so they are stored
+	//		 and reported by the main thread in the input order.
+	try
+	{
+		init_processor(a_job. processor, a_job. line);
+
+		const timepoint_t t0 = ch::high_resolution_clock::now();
+		a_job. iteration_count = a_job. processor. run();
+		a_job. parse_time = ch::high_resolution_clock::now() - t0;
+	}
+	catch (const std::bad_alloc&)
+	{
+		a_job. failure = "input pool overflow";
+	}
+	catch (const ex::generic_error& err)
+	{
+		a_job. error. reset(new ex::generic_error(err));
+	}
+	catch (const std::exception& err)
+	{
+		a_job. failure = err. what();
+	}
+}
+
+void nParseApp::configure_processor (anta::Processor<NLG>& a_proc)
+{
+#if defined(DEBUG_PRINT)
+	if (! m_debug_print. empty())
+	{
+		a_proc. get_observer(). link(open_file(m_debug_print));
+	}
+#endif
+#if defined(NPARSE_SWAP_FILE)
+	if (! m_input_swap. empty())
+	{
+		a_proc. set_swap_file(m_input_swap);
+	}
+#endif
+	a_proc. set_capacity(m_input_pool);
+	a_proc. set_lr_threshold(m_lr_threshold);
+	a_proc. set_memoization(m_memoize);
+	a_proc. set_beam_width(static_cast<anta::uint_t>(m_beam_width));
+	a_proc. set_max_traces(static_cast<anta::uint_t>(m_max_traces));
+	a_proc. set_merging(m_merge);
+}
+
+void nParseApp::init_processor (anta::Processor<NLG>& a_proc,
+		const nlg_string_t& a_line)
+{
+	// Prepare input text range.
+	anta::range<NLG>::type src;
+	src. first = &* a_line. begin();
+	src. second = src. first + a_line. size();
+
+	// Initialize the processor.
+	a_proc. init(src. first, src. second);
+
+	// Assign initial values to trace variables.
+	for (init_t::const_iterator i = m_init. begin(); i != m_init. end(); ++ i)
+	{
+		a_proc. ref(i -> first) = i -> second;
+	}
+}
+
+void nParseApp::print_results (TracerNLG& a_trac,
+		const anta::Processor<NLG>& a_proc, const dt_t& a_parse_time,
+		const anta::uint_t a_total_iteration_count)
+{
+	// Unroll and print traces.
+	print_traces(a_trac);
+
+	// Print syntax tree.
+	print_syntax_tree(a_trac);
+
+	// Print final states.
+	print_final_states(a_proc);
+
+	// Print explicitly specified variables.
+	print_variables(a_proc);
+
+	// Print statistics.
+	print_stats(a_proc, a_parse_time, a_total_iteration_count);
+}
+
 void nParseApp::print_traces (TracerNLG& a_trac)
 {
 	if (m_trace_print. empty())
@@ -876,7 +1117,7 @@ void nParseApp::print_stats (const anta::Processor<NLG>& a_proc,
 		<< std::setprecision(2)
 		<< "\n"
 		   "trace count: "
-		<< a_proc. get_traced(). size()
+		<< a_proc. get_trace_count()
 		<< "\n"
 		   "iteration count: "
 		<< a_total_iteration_count
@@ -52,8 +52,20 @@ private:
 	std::ostream* open_file (const std::string& a_name);
 	int compile_grammar ();
 	int parse_input_text ();
+	int parse_input_batch ();
+	bool read_record (nparse::nlg_string_t& a_line, const char a_delim);
 
 private:
+	struct job;
+
+	void run_job (job& a_job);
+	void configure_processor (anta::Processor<nparse::NLG>& a_proc);
+	void init_processor (anta::Processor<nparse::NLG>& a_proc,
+			const nparse::nlg_string_t& a_line);
+	void print_results (TracerNLG& a_trac,
+			const anta::Processor<nparse::NLG>& a_proc,
+			const boost::chrono::duration<double>& a_parse_time,
+			const anta::uint_t a_iteration_count);
 	void print_traces (TracerNLG& a_trac);
 	void print_final_states (const anta::Processor<nparse::NLG>& a_proc);
 	void print_variables (const anta::Processor<nparse::NLG>& a_proc);
@@ -78,6 +90,11 @@ private:
 	std::string m_entry_point;
 	int m_entry_label;
 	long m_lr_threshold;
+	bool m_memoize;
+	long m_beam_width;
+	long m_max_traces;
+	bool m_merge;
+	long m_jobs;
 #if defined(DEBUG_PRINT)
 	std::string m_debug_print;
 #endif